@@ -0,0 +1,43 @@
+#include <string.h>
+#include "assets.h"
+#include "assets_data.h"
+
+uint asset_sprite_count(void) {
+  return ASSET_SPRITE_COUNT;
+}
+
+// cores da paleta dos sprites já em GRB na ordem do fio, sem brilho aplicado
+uint asset_sprite_palette(const uint32_t **colors) {
+  *colors = asset_palette;
+  return ASSET_PALETTE_SIZE;
+}
+
+// expande as corridas do sprite em dst (um LED por palavra). A paleta é passada pelo chamador para
+// que o brilho seja aplicado nas poucas cores dela e não em cada LED
+void asset_sprite_decode(uint sprite, const uint32_t palette[], uint32_t dst[]) {
+  const uint8_t *run = &asset_sprite_runs[asset_sprite_offset[sprite]];
+  const uint8_t *end = &asset_sprite_runs[asset_sprite_offset[sprite + 1]];
+  for (; run < end; ++run) {
+    uint32_t color = palette[*run & 0x0F];
+    for (uint n = (*run >> 4) + 1; n > 0; --n)
+      *dst++ = color;
+  }
+}
+
+// preenche as 8 colunas do glifo de c; devolve false para caracteres sem glifo
+bool asset_glyph_decode(char c, uint8_t columns[ASSET_GLYPH_WIDTH]) {
+  uint8_t code = (uint8_t)c;
+  for (uint i = 0; i < ASSET_FONT_RANGES; ++i) {
+    uint8_t offset = code - asset_font_range_first[i];
+    if (code < asset_font_range_first[i] || offset >= asset_font_range_count[i])
+      continue;
+
+    const uint8_t *glyph = &asset_glyph_data[asset_glyph_offset[asset_font_range_glyph[i] + offset]];
+    uint8_t first = glyph[0] >> 4;
+    uint8_t count = glyph[0] & 0x0F;
+    memset(columns, 0, ASSET_GLYPH_WIDTH);
+    memcpy(&columns[first], &glyph[1], count);
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,19 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "pico/stdlib.h"
+
+// Sprites da matriz de LEDs e fonte do OLED, gerados no build por tools/asset_gen.py a partir de
+// assets/*.txt. Os dados são const e ficam na flash; nada é copiado para a SRAM no boot. Os
+// decodificadores expandem direto no destino: o sprite em palavras GRB na ordem do fio e o glifo
+// em colunas no formato de página do SSD1306.
+
+#define ASSET_PALETTE_MAX 16
+#define ASSET_GLYPH_WIDTH 8
+
+uint asset_sprite_count(void);
+uint asset_sprite_palette(const uint32_t **colors);
+void asset_sprite_decode(uint sprite, const uint32_t palette[], uint32_t dst[]);
+bool asset_glyph_decode(char c, uint8_t columns[ASSET_GLYPH_WIDTH]);
+
+#endif
@@ -0,0 +1,143 @@
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "audio.h"
+
+const uint16_t audio_note_div[NOTE_COUNT] = {
+  AUDIO_DIV(262), AUDIO_DIV(277), AUDIO_DIV(294), AUDIO_DIV(311), AUDIO_DIV(330), AUDIO_DIV(349),
+  AUDIO_DIV(370), AUDIO_DIV(392), AUDIO_DIV(415), AUDIO_DIV(440), AUDIO_DIV(466), AUDIO_DIV(494),
+  AUDIO_DIV(523), AUDIO_DIV(554), AUDIO_DIV(587), AUDIO_DIV(622), AUDIO_DIV(659), AUDIO_DIV(698),
+  AUDIO_DIV(740), AUDIO_DIV(784), AUDIO_DIV(831), AUDIO_DIV(880), AUDIO_DIV(932), AUDIO_DIV(988),
+  AUDIO_DIV(1047), AUDIO_DIV(1109), AUDIO_DIV(1175), AUDIO_DIV(1245), AUDIO_DIV(1319), AUDIO_DIV(1397),
+  AUDIO_DIV(1480), AUDIO_DIV(1568), AUDIO_DIV(1661), AUDIO_DIV(1760), AUDIO_DIV(1865), AUDIO_DIV(1976),
+};
+
+#define AUDIO_SAMPLES(ms) ((ms) * AUDIO_ENVELOPE_HZ / 1000)
+
+static uint16_t attack_levels[AUDIO_SAMPLES(10)];
+static uint16_t release_levels[AUDIO_SAMPLES(30)];
+static uint16_t pluck_levels[AUDIO_SAMPLES(2) + AUDIO_SAMPLES(150)];
+static const uint16_t sustain_levels[1] = { AUDIO_LEVEL_MAX };
+static const uint16_t silence_levels[1] = { 0 };
+
+audio_envelope_t audio_env_attack = { attack_levels, AUDIO_SAMPLES(10) };
+audio_envelope_t audio_env_release = { release_levels, AUDIO_SAMPLES(30) };
+audio_envelope_t audio_env_pluck = { pluck_levels, AUDIO_SAMPLES(2) + AUDIO_SAMPLES(150) };
+audio_envelope_t audio_env_sustain = { sustain_levels, 1 };
+audio_envelope_t audio_env_silence = { silence_levels, 1 };
+
+static uint audio_slice;
+static int audio_dma_channel;
+static int audio_alarm;
+
+// sequência em reprodução; só é alterada com a interrupção do alarme desligada
+static const audio_step_t *audio_steps;
+static uint audio_count;
+static uint audio_index;
+static volatile bool audio_playing;
+static bool audio_sounding; // o último passo iniciado deixa o buzzer soando
+
+// passos internos de audio_tone e audio_stop
+static audio_step_t audio_tone_step;
+static audio_step_t audio_stop_step;
+
+// rampa linear de from até to, sem incluir from
+static void audio_ramp(uint16_t levels[], uint count, uint from, uint to) {
+  for (uint i = 0; i < count; ++i)
+    levels[i] = from + ((int)to - (int)from) * (int)(i + 1) / (int)count;
+}
+
+static void audio_start_step(void) {
+  const audio_step_t *step = &audio_steps[audio_index];
+
+  dma_channel_abort(audio_dma_channel);
+  if (step->div != AUDIO_DIV_KEEP)
+    pwm_set_clkdiv_int_frac(audio_slice, step->div >> 4, step->div & 0xF);
+  dma_channel_transfer_from_buffer_now(audio_dma_channel, step->envelope->levels, step->envelope->length);
+
+  if (step->duration_ms)
+    hardware_alarm_set_target(audio_alarm, make_timeout_time_ms(step->duration_ms));
+  else
+    audio_playing = false;
+}
+
+// fim do passo atual (interrupção do alarme, no núcleo que chamou audio_init)
+static void audio_alarm_callback(uint alarm_num) {
+  (void)alarm_num;
+  if (++audio_index < audio_count) {
+    audio_start_step();
+  } else {
+    audio_playing = false;
+  }
+}
+
+// o alarme interrompe o núcleo que chama audio_init; as demais funções devem ser chamadas nele
+void audio_init(uint pin) {
+  audio_ramp(attack_levels, AUDIO_SAMPLES(10), 0, AUDIO_LEVEL_MAX);
+  audio_ramp(release_levels, AUDIO_SAMPLES(30), AUDIO_LEVEL_MAX, 0);
+  audio_ramp(pluck_levels, AUDIO_SAMPLES(2), 0, AUDIO_LEVEL_MAX);
+  audio_ramp(&pluck_levels[AUDIO_SAMPLES(2)], AUDIO_SAMPLES(150), AUDIO_LEVEL_MAX, 0);
+
+  gpio_set_function(pin, GPIO_FUNC_PWM);
+  audio_slice = pwm_gpio_to_slice_num(pin);
+
+  pwm_config config = pwm_get_default_config();
+  pwm_config_set_wrap(&config, AUDIO_PWM_WRAP);
+  pwm_init(audio_slice, &config, false);
+  pwm_set_gpio_level(pin, 0);
+  pwm_set_enabled(audio_slice, true);
+
+  // timer de DMA em clk_sys * 1 / (clk_sys / AUDIO_ENVELOPE_HZ) marca o ritmo das amostras
+  int timer = dma_claim_unused_timer(true);
+  dma_timer_set_fraction(timer, 1, AUDIO_CLOCK_HZ / AUDIO_ENVELOPE_HZ);
+
+  // escritas de 16 bits num registrador de periférico são replicadas nas duas metades, então o
+  // nível vale para os dois canais da fatia; o outro pino da fatia não está no modo PWM
+  audio_dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config dma_config = dma_channel_get_default_config(audio_dma_channel);
+  channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_16);
+  channel_config_set_read_increment(&dma_config, true);
+  channel_config_set_write_increment(&dma_config, false);
+  channel_config_set_dreq(&dma_config, dma_get_timer_dreq(timer));
+  dma_channel_configure(audio_dma_channel, &dma_config, &pwm_hw->slice[audio_slice].cc, silence_levels, 1, false);
+
+  audio_alarm = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(audio_alarm, audio_alarm_callback);
+}
+
+// substitui o que estiver tocando pela sequência; steps precisa existir até o fim da reprodução
+void audio_play(const audio_step_t steps[], uint count) {
+  if (count == 0)
+    return;
+
+  uint32_t status = save_and_disable_interrupts();
+  hardware_alarm_cancel(audio_alarm);
+  audio_steps = steps;
+  audio_count = count;
+  audio_index = 0;
+  audio_playing = true;
+  audio_sounding = steps != &audio_stop_step;
+  audio_start_step();
+  restore_interrupts(status);
+}
+
+// tom contínuo; o ataque suave só é usado se o buzzer estava em silêncio, senão só a frequência muda
+void audio_tone(uint16_t div) {
+  const audio_envelope_t *envelope = audio_sounding && !audio_playing ? &audio_env_sustain : &audio_env_attack;
+  audio_tone_step = (audio_step_t){ .div = div, .duration_ms = 0, .envelope = envelope };
+  audio_play(&audio_tone_step, 1);
+}
+
+// solta a nota atual e termina em silêncio
+void audio_stop(void) {
+  if (!audio_sounding)
+    return;
+  audio_stop_step = (audio_step_t){ .div = AUDIO_DIV_KEEP, .duration_ms = 0, .envelope = &audio_env_release };
+  audio_play(&audio_stop_step, 1);
+}
+
+// há uma sequência com passos temporizados ainda em reprodução
+bool audio_busy(void) {
+  return audio_playing;
+}
@@ -0,0 +1,59 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "pico/stdlib.h"
+
+// Motor de tons para o buzzer. O PWM roda com wrap fixo e a frequência de cada nota é só o divisor
+// de clock (8.4 bits), calculado em tempo de compilação com AUDIO_DIV. Com o wrap fixo, o nível do
+// PWM tem a mesma escala para qualquer nota, então os envelopes são tabelas de níveis que um canal
+// de DMA copia para o registrador de comparação do PWM no ritmo de um timer de DMA: nenhuma CPU por
+// amostra. A CPU só escreve no hardware nas transições entre passos de uma sequência, disparadas
+// por um alarme de hardware.
+
+#define AUDIO_CLOCK_HZ 125000000u
+#define AUDIO_PWM_WRAP 4095u
+#define AUDIO_LEVEL_MAX ((AUDIO_PWM_WRAP + 1) / 2) // ciclo de trabalho de 50%
+#define AUDIO_ENVELOPE_HZ 2000u // amostras de envelope por segundo
+
+// divisor 8.4 para a frequência em Hz, arredondado; cobre de ~120 Hz a ~30 kHz
+#define AUDIO_DIV(hz) ((uint16_t)(((uint64_t)AUDIO_CLOCK_HZ * 16 + (AUDIO_PWM_WRAP + 1) * (uint64_t)(hz) / 2) / \
+                                  ((AUDIO_PWM_WRAP + 1) * (uint64_t)(hz))))
+#define AUDIO_DIV_KEEP 0 // passo que mantém a frequência atual
+
+// notas de C4 a B6
+enum {
+  NOTE_C4, NOTE_CS4, NOTE_D4, NOTE_DS4, NOTE_E4, NOTE_F4, NOTE_FS4, NOTE_G4, NOTE_GS4, NOTE_A4, NOTE_AS4, NOTE_B4,
+  NOTE_C5, NOTE_CS5, NOTE_D5, NOTE_DS5, NOTE_E5, NOTE_F5, NOTE_FS5, NOTE_G5, NOTE_GS5, NOTE_A5, NOTE_AS5, NOTE_B5,
+  NOTE_C6, NOTE_CS6, NOTE_D6, NOTE_DS6, NOTE_E6, NOTE_F6, NOTE_FS6, NOTE_G6, NOTE_GS6, NOTE_A6, NOTE_AS6, NOTE_B6,
+  NOTE_COUNT
+};
+
+extern const uint16_t audio_note_div[NOTE_COUNT];
+
+typedef struct {
+  const uint16_t *levels; // níveis do PWM, de 0 a AUDIO_LEVEL_MAX
+  uint16_t length;
+} audio_envelope_t;
+
+// envelopes prontos, preenchidos por audio_init
+extern audio_envelope_t audio_env_attack; // 0 -> máximo em 10 ms, depois sustenta
+extern audio_envelope_t audio_env_release; // máximo -> 0 em 30 ms
+extern audio_envelope_t audio_env_pluck; // ataque de 2 ms e decaimento até 0 em 150 ms
+extern audio_envelope_t audio_env_sustain; // máximo
+extern audio_envelope_t audio_env_silence;
+
+// um passo toca o envelope na frequência do divisor. duration_ms 0 sustenta o passo até a próxima
+// chamada de audio_play/audio_stop; ao fim da sequência fica o último nível do último envelope
+typedef struct {
+  uint16_t div;
+  uint16_t duration_ms;
+  const audio_envelope_t *envelope;
+} audio_step_t;
+
+void audio_init(uint pin);
+void audio_play(const audio_step_t steps[], uint count);
+void audio_tone(uint16_t div);
+void audio_stop(void);
+bool audio_busy(void);
+
+#endif
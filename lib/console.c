@@ -0,0 +1,72 @@
+#include <string.h>
+#include "hardware/sync.h"
+#include "console.h"
+
+void console_init(console_t *console, ssd1306_t *ssd) {
+  console->ssd = ssd;
+  console_clear(console);
+}
+
+// apaga as linhas e volta a tela para a página 0
+void console_clear(console_t *console) {
+  ssd1306_t *ssd = console->ssd;
+  console->head = 0;
+  console->count = 0;
+  ssd1306_fill(ssd, false);
+  ssd1306_set_start_line(ssd, 0);
+}
+
+// escreve uma linha no fim do console. Até a tela encher as linhas descem sem rolar; depois, cada
+// linha ocupa a página da mais antiga e a tela passa a começar na página seguinte a ela
+void console_print(console_t *console, const char *str) {
+  ssd1306_t *ssd = console->ssd;
+  uint8_t page = console->head;
+  uint8_t y = page << 3;
+
+  // caracteres sem glifo não desenham nada, então a página é apagada antes. As colunas que ficam
+  // iguais ao que o display já mostra são descartadas no envio
+  ssd1306_rect(ssd, y, 0, ssd->width, 8, false, true);
+  for (uint8_t x = 0; *str && *str != '\n' && x + 8 <= ssd->width; x += 8)
+    ssd1306_draw_char(ssd, *str++, x, y);
+
+  console->head = (page + 1) % ssd->pages;
+  if (console->count < ssd->pages)
+    console->count++;
+  if (console->count == ssd->pages)
+    ssd1306_set_start_line(ssd, console->head << 3);
+}
+
+void console_queue_init(console_queue_t *queue) {
+  *queue = (console_queue_t){ 0 };
+}
+
+// chamada apenas pelo produtor; a linha é cortada em CONSOLE_COLUMNS caracteres
+bool console_queue_push(console_queue_t *queue, const char *str) {
+  uint32_t head = queue->head;
+  if (head - queue->tail == CONSOLE_QUEUE_SIZE) {
+    queue->dropped++;
+    return false;
+  }
+
+  char *line = queue->lines[head & CONSOLE_QUEUE_MASK];
+  strncpy(line, str, CONSOLE_COLUMNS);
+  line[CONSOLE_COLUMNS] = '\0';
+  // a linha precisa estar completa na memória antes de o consumidor enxergar o novo head
+  __dmb();
+  queue->head = head + 1;
+  __sev();
+  return true;
+}
+
+// chamada apenas pelo consumidor; devolve false quando não há linhas
+bool console_queue_pop(console_queue_t *queue, char line[CONSOLE_COLUMNS + 1]) {
+  uint32_t tail = queue->tail;
+  if (queue->head == tail)
+    return false;
+
+  __dmb();
+  memcpy(line, queue->lines[tail & CONSOLE_QUEUE_MASK], CONSOLE_COLUMNS + 1);
+  __dmb();
+  queue->tail = tail + 1;
+  return true;
+}
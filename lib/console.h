@@ -0,0 +1,46 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Console de texto no SSD1306 com rolagem por hardware. Cada página da GDDRAM guarda uma linha de
+// texto de 8 pixels e as páginas são usadas como um buffer circular: uma linha nova sobrescreve a
+// mais antiga e o registrador de linha inicial (SET_DISP_START_LINE) gira a tela para que ela
+// apareça embaixo. Uma linha nova custa no máximo uma página (128 bytes) e um comando, em vez do
+// quadro inteiro.
+//
+// A linha inicial desloca a tela toda, então o console ocupa o display inteiro e não convive com
+// desenhos em coordenadas de tela. As linhas vão para o destino de desenho atual (o fundo ou a
+// camada selecionada) e chegam ao display no próximo ssd1306_send_data ou ssd1306_send_data_async.
+//
+// A fila de linhas leva o texto de um núcleo para o outro, sem trava: um produtor (quem recebe os
+// comandos) e um consumidor (o dono do display). Ao contrário dos retratos, cada linha conta, então
+// com a fila cheia a linha nova é descartada e contada.
+
+#define CONSOLE_COLUMNS (WIDTH / 8) // caracteres por linha; o excedente é descartado
+#define CONSOLE_QUEUE_SIZE 8 // potência de 2
+#define CONSOLE_QUEUE_MASK (CONSOLE_QUEUE_SIZE - 1)
+
+typedef struct {
+  ssd1306_t *ssd;
+  uint8_t head; // página que recebe a próxima linha
+  uint8_t count; // linhas escritas até encher a tela
+} console_t;
+
+typedef struct {
+  char lines[CONSOLE_QUEUE_SIZE][CONSOLE_COLUMNS + 1];
+  volatile uint32_t head; // escrito apenas pelo produtor
+  volatile uint32_t tail; // escrito apenas pelo consumidor
+  uint32_t dropped; // linhas descartadas com a fila cheia
+} console_queue_t;
+
+void console_init(console_t *console, ssd1306_t *ssd);
+void console_clear(console_t *console);
+void console_print(console_t *console, const char *str);
+
+void console_queue_init(console_queue_t *queue);
+bool console_queue_push(console_queue_t *queue, const char *str);
+bool console_queue_pop(console_queue_t *queue, char line[CONSOLE_COLUMNS + 1]);
+
+#endif
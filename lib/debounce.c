@@ -0,0 +1,87 @@
+#include "hardware/timer.h"
+#include "debounce.h"
+
+static debounce_button_t buttons[DEBOUNCE_MAX_BUTTONS];
+static uint button_count;
+
+static input_queue_t *debounce_queue;
+static int debounce_alarm;
+static volatile bool sampling;
+
+volatile uint32_t debounce_tick_max_us = 0;
+volatile uint32_t debounce_edge_max_us = 0;
+
+// arma o alarme para a próxima amostra. O SDK devolve true e não arma quando o alvo já passou (o
+// núcleo pode ter ficado mais que DEBOUNCE_SAMPLE_US em outra interrupção); sem o alarme a
+// amostragem nunca terminaria e os botões parariam de responder, então o alvo é recalculado
+static void debounce_schedule(uint alarm_num) {
+  while (hardware_alarm_set_target(alarm_num, make_timeout_time_us(DEBOUNCE_SAMPLE_US)))
+    continue;
+}
+
+// amostra todos os botões; reagenda a si mesma enquanto algum estiver pressionado ou instável
+static void debounce_tick(uint alarm_num) {
+  uint32_t now_us = time_us_32();
+  bool active = false;
+
+  for (uint i = 0; i < button_count; ++i) {
+    debounce_button_t *button = &buttons[i];
+    bool level_pressed = !gpio_get(button->gpio);
+
+    if (level_pressed == button->pressed) {
+      button->count = 0;
+    } else if (++button->count >= DEBOUNCE_STABLE_SAMPLES) {
+      button->pressed = level_pressed;
+      button->count = 0;
+      input_queue_push_from_isr(debounce_queue, button->gpio, level_pressed ? INPUT_EVENT_PRESS : INPUT_EVENT_RELEASE);
+      button->repeat_at_us = now_us + DEBOUNCE_REPEAT_DELAY_MS * 1000;
+    }
+
+    if (button->pressed && button->repeat && (int32_t)(now_us - button->repeat_at_us) >= 0) {
+      input_queue_push_from_isr(debounce_queue, button->gpio, INPUT_EVENT_REPEAT);
+      button->repeat_at_us += DEBOUNCE_REPEAT_PERIOD_MS * 1000;
+    }
+
+    if (button->pressed || button->count)
+      active = true;
+  }
+
+  if (active) {
+    debounce_schedule(alarm_num);
+  } else {
+    sampling = false;
+  }
+
+  uint32_t elapsed_us = time_us_32() - now_us;
+  if (elapsed_us > debounce_tick_max_us)
+    debounce_tick_max_us = elapsed_us;
+}
+
+// o alarme interrompe o núcleo que chama debounce_init, que deve ser o mesmo das interrupções de GPIO
+void debounce_init(input_queue_t *queue) {
+  debounce_queue = queue;
+  button_count = 0;
+  sampling = false;
+  debounce_alarm = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(debounce_alarm, debounce_tick);
+}
+
+void debounce_add(uint gpio, bool repeat) {
+  if (button_count == DEBOUNCE_MAX_BUTTONS)
+    return;
+  buttons[button_count++] = (debounce_button_t){ .gpio = gpio, .repeat = repeat, .pressed = !gpio_get(gpio) };
+}
+
+// chamada na interrupção de GPIO, em qualquer borda de um botão registrado
+void debounce_edge(uint gpio) {
+  (void)gpio;
+  if (sampling)
+    return;
+  uint32_t start_us = time_us_32();
+  sampling = true;
+  debounce_schedule(debounce_alarm);
+
+  uint32_t elapsed_us = time_us_32() - start_us;
+  if (elapsed_us > debounce_edge_max_us)
+    debounce_edge_max_us = elapsed_us;
+}
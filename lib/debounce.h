@@ -0,0 +1,38 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include "pico/stdlib.h"
+#include "input_queue.h"
+
+// Debounce independente por botão, por amostragem num alarme de hardware. Uma borda em qualquer
+// botão só liga a amostragem (1 ms); cada botão confirma a mudança de nível depois de
+// DEBOUNCE_STABLE_SAMPLES amostras iguais seguidas e a amostragem para sozinha quando todos estão
+// soltos e estáveis. Os eventos confirmados (pressão, repetição e soltura) vão para a fila de
+// entrada; o alarme é o único produtor da fila.
+//
+// Botões ativos em nível baixo (pull-up). Com repeat, segurar o botão gera um evento de repetição
+// depois de DEBOUNCE_REPEAT_DELAY_MS e depois a cada DEBOUNCE_REPEAT_PERIOD_MS.
+
+#define DEBOUNCE_MAX_BUTTONS 4
+#define DEBOUNCE_SAMPLE_US 1000
+#define DEBOUNCE_STABLE_SAMPLES 4 // confirmação em ~4 ms depois do último repique
+#define DEBOUNCE_REPEAT_DELAY_MS 400
+#define DEBOUNCE_REPEAT_PERIOD_MS 80
+
+typedef struct {
+  uint gpio;
+  bool repeat;
+  bool pressed; // estado confirmado
+  uint8_t count; // amostras seguidas diferentes do estado confirmado
+  uint32_t repeat_at_us;
+} debounce_button_t;
+
+void debounce_init(input_queue_t *queue);
+void debounce_add(uint gpio, bool repeat);
+void debounce_edge(uint gpio);
+
+// maior tempo de uma amostragem (alarme) e de uma borda que ligou a amostragem (GPIO)
+extern volatile uint32_t debounce_tick_max_us;
+extern volatile uint32_t debounce_edge_max_us;
+
+#endif
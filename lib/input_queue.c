@@ -0,0 +1,46 @@
+#include "hardware/sync.h"
+#include "input_queue.h"
+
+void input_queue_init(input_queue_t *queue) {
+  *queue = (input_queue_t){ 0 };
+}
+
+// chamada dentro da interrupção; o tempo dela entra na medição da amostragem do debounce
+void input_queue_push_from_isr(input_queue_t *queue, uint gpio, uint32_t events) {
+  uint32_t now_us = time_us_32();
+  uint32_t head = queue->head;
+
+  if (head - queue->tail == INPUT_QUEUE_SIZE) {
+    queue->overflows++;
+  } else {
+    queue->slots[head & INPUT_QUEUE_MASK] = (input_event_t){
+      .time_us = now_us,
+      .gpio = gpio,
+      .events = events,
+    };
+    // o evento precisa estar completo antes de o laço principal enxergar o novo head
+    __dmb();
+    queue->head = head + 1;
+    // acorda o laço principal se ele estiver parado no __wfe
+    __sev();
+  }
+
+  queue->isr_count++;
+}
+
+// chamada no laço principal; devolve false quando não há eventos
+bool input_queue_pop(input_queue_t *queue, input_event_t *event) {
+  uint32_t tail = queue->tail;
+  if (queue->head == tail)
+    return false;
+
+  __dmb();
+  *event = queue->slots[tail & INPUT_QUEUE_MASK];
+  __dmb();
+  queue->tail = tail + 1;
+  return true;
+}
+
+bool input_queue_empty(input_queue_t *queue) {
+  return queue->head == queue->tail;
+}
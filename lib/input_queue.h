@@ -0,0 +1,39 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include "pico/stdlib.h"
+
+// Fila de eventos dos botões, sem trava. Uma única interrupção produz (o alarme do debounce) e só
+// carimba o instante e enfileira; mudanças de estado e mensagens ficam no laço principal. A
+// publicação tem custo fixo (sem laços nem printf).
+
+#define INPUT_QUEUE_SIZE 16 // potência de 2
+#define INPUT_QUEUE_MASK (INPUT_QUEUE_SIZE - 1)
+
+typedef struct {
+  uint32_t time_us; // instante da interrupção
+  uint8_t gpio;
+  uint8_t events; // INPUT_EVENT_*
+} input_event_t;
+
+// tipos de evento confirmados pelo debounce
+#define INPUT_EVENT_PRESS 0x10u
+#define INPUT_EVENT_REPEAT 0x20u
+#define INPUT_EVENT_RELEASE 0x40u
+
+typedef struct {
+  input_event_t slots[INPUT_QUEUE_SIZE];
+  volatile uint32_t head; // escrito apenas pela interrupção
+  volatile uint32_t tail; // escrito apenas pelo laço principal
+
+  // estatísticas da interrupção
+  volatile uint32_t isr_count;
+  volatile uint32_t overflows; // eventos perdidos com a fila cheia
+} input_queue_t;
+
+void input_queue_init(input_queue_t *queue);
+void input_queue_push_from_isr(input_queue_t *queue, uint gpio, uint32_t events);
+bool input_queue_pop(input_queue_t *queue, input_event_t *event);
+bool input_queue_empty(input_queue_t *queue);
+
+#endif
@@ -0,0 +1,272 @@
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "joystick.h"
+#include "trace.h"
+
+// o DMA com ring de escrita exige o buffer alinhado ao próprio tamanho
+static uint16_t samples[JOYSTICK_RING_SAMPLES] __attribute__((aligned(1u << JOYSTICK_RING_BITS)));
+static int dma_channel = -1;
+// canal convertido primeiro e posição (par ou ímpar) das amostras do eixo x no buffer
+static uint first_input;
+static uint x_slot;
+static uint x_input, y_input;
+
+static joystick_axis_t axis_x = { .out_center = 60, .out_range = 60 };
+// o eixo y do ADC cresce para cima e o da tela para baixo
+static joystick_axis_t axis_y = { .out_center = 28, .out_range = 28, .invert = true };
+static uint16_t dead_zone = JOYSTICK_DEAD_ZONE_DEFAULT;
+// curva de resposta: entrada normalizada i/16 -> saída, ambas em Q12
+static uint16_t curve[JOYSTICK_CURVE_POINTS];
+
+static void joystick_start_dma(void) {
+  dma_channel_config config = dma_channel_get_default_config(dma_channel);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+  channel_config_set_read_increment(&config, false);
+  channel_config_set_write_increment(&config, true);
+  channel_config_set_ring(&config, true, JOYSTICK_RING_BITS);
+  channel_config_set_dreq(&config, DREQ_ADC);
+
+  // contagem máxima: a 8 kHz são mais de 6 dias até o joystick_read precisar rearmar o canal
+  dma_channel_configure(dma_channel, &config, samples, &adc_hw->fifo, 0xFFFFFFFF, true);
+}
+
+// round robin entre os dois eixos a partir do primeiro canal, cada conversão copiada pelo DMA
+static void joystick_start_capture(void) {
+  adc_select_input(first_input);
+  adc_set_round_robin((1u << x_input) | (1u << y_input));
+  // FIFO ligada, DREQ a cada amostra, sem bit de erro e sem reduzir para 8 bits
+  adc_fifo_setup(true, true, 1, false, false);
+  joystick_start_dma();
+  adc_run(true);
+}
+
+void joystick_init(uint x_pin, uint y_pin) {
+  // inicializa o hardware adc
+  adc_init();
+
+  // inicialização dos pinos analógicos
+  adc_gpio_init(x_pin);
+  adc_gpio_init(y_pin);
+
+  x_input = x_pin - 26;
+  y_input = y_pin - 26;
+  first_input = x_input < y_input ? x_input : y_input;
+  // o round robin percorre os canais em ordem crescente a partir do selecionado, e o buffer tem
+  // tamanho par, então cada eixo ocupa sempre as mesmas posições (pares ou ímpares)
+  x_slot = x_input == first_input ? 0 : 1;
+
+  adc_set_clkdiv(48000000.f / JOYSTICK_SAMPLE_RATE_HZ - 1);
+
+  dma_channel = dma_claim_unused_channel(true);
+  joystick_start_capture();
+
+  // espera o buffer encher e mede o centro com o joystick em repouso
+  joystick_set_response(JOYSTICK_DEAD_ZONE_DEFAULT, 0);
+  sleep_us(JOYSTICK_RING_SAMPLES * 1000000ull / JOYSTICK_SAMPLE_RATE_HZ);
+  joystick_calibrate();
+}
+
+// média das amostras de cada eixo presentes no buffer (sobreamostragem + decimação)
+void joystick_read(uint16_t *x_value, uint16_t *y_value) {
+  // contagem do DMA esgotada: reinicia a captura a partir do primeiro canal
+  if (!dma_channel_is_busy(dma_channel)) {
+    adc_run(false);
+    adc_fifo_drain();
+    joystick_start_capture();
+  }
+
+  uint32_t sum[2] = { 0, 0 };
+  for (uint i = 0; i < JOYSTICK_RING_SAMPLES; i += 2) {
+    sum[0] += samples[i];
+    sum[1] += samples[i + 1];
+  }
+
+  uint32_t count = JOYSTICK_RING_SAMPLES / 2;
+  *x_value = sum[x_slot] / count;
+  *y_value = sum[x_slot ^ 1] / count;
+}
+
+// para a captura contínua (8000 conversões por segundo) enquanto o sistema está ocioso
+void joystick_suspend(void) {
+  adc_run(false);
+  dma_channel_abort(dma_channel);
+  adc_fifo_drain();
+  adc_set_round_robin(0);
+  adc_fifo_setup(false, false, 0, false, false);
+}
+
+// uma conversão de cada eixo, sem DMA; só com a captura suspensa
+void joystick_sample(uint16_t *x_value, uint16_t *y_value) {
+  adc_select_input(x_input);
+  *x_value = adc_read();
+  adc_select_input(y_input);
+  *y_value = adc_read();
+}
+
+// volta à captura contínua. O buffer guardava a posição de antes da suspensão; ele é preenchido
+// com a última amostra para a primeira leitura não mostrar a posição antiga
+void joystick_resume(void) {
+  uint16_t x_value;
+  uint16_t y_value;
+  joystick_sample(&x_value, &y_value);
+  for (uint i = 0; i < JOYSTICK_RING_SAMPLES; i += 2) {
+    samples[i + x_slot] = x_value;
+    samples[i + (x_slot ^ 1)] = y_value;
+  }
+  joystick_start_capture();
+}
+
+static void joystick_update_scales(joystick_axis_t *axis) {
+  int32_t center = axis->center_q4 >> 4;
+  int32_t neg_span = center - axis->min - dead_zone;
+  int32_t pos_span = axis->max - center - dead_zone;
+  if (neg_span < 1)
+    neg_span = 1;
+  if (pos_span < 1)
+    pos_span = 1;
+  // arredondada para cima: no extremo a excursão normalizada chega a 4096 e o quadrado à borda
+  axis->neg_scale = ((4096 << 16) + neg_span - 1) / neg_span;
+  axis->pos_scale = ((4096 << 16) + pos_span - 1) / pos_span;
+  axis->scale_center = center;
+}
+
+static void joystick_calibrate_axis(joystick_axis_t *axis, uint16_t value) {
+  axis->center_q4 = value << 4;
+  // extremos iniciais conservadores: 90% da distância até cada limite do ADC
+  axis->min = value - (value * 9) / 10;
+  axis->max = value + ((4095 - value) * 9) / 10;
+  joystick_update_scales(axis);
+}
+
+// mede o centro dos dois eixos a partir da média atual (joystick em repouso)
+void joystick_calibrate(void) {
+  uint16_t x_value;
+  uint16_t y_value;
+  joystick_read(&x_value, &y_value);
+  joystick_calibrate_axis(&axis_x, x_value);
+  joystick_calibrate_axis(&axis_y, y_value);
+}
+
+void joystick_set_output(int16_t x_center, int16_t x_range, int16_t y_center, int16_t y_range) {
+  axis_x.out_center = x_center;
+  axis_x.out_range = x_range;
+  axis_y.out_center = y_center;
+  axis_y.out_range = y_range;
+}
+
+// zona morta em contagens do ADC e curva expo: saída = t + expo * (t^3 - t), com expo em Q8
+// (0 = linear, 255 = quase cúbica), calculada uma vez em Q12
+void joystick_set_response(uint16_t dead_zone_counts, uint8_t expo) {
+  dead_zone = dead_zone_counts;
+  for (uint i = 0; i < JOYSTICK_CURVE_POINTS; ++i) {
+    int32_t t = (i << 12) / (JOYSTICK_CURVE_POINTS - 1);
+    int32_t cube = (((t * t) >> 12) * t) >> 12;
+    curve[i] = t + ((expo * (cube - t)) >> 8);
+  }
+  joystick_update_scales(&axis_x);
+  joystick_update_scales(&axis_y);
+}
+
+static int joystick_map_axis(joystick_axis_t *axis, int32_t value) {
+  // acompanha os extremos que o potenciômetro realmente alcança
+  if (value < axis->min || value > axis->max) {
+    if (value < axis->min)
+      axis->min = value;
+    else
+      axis->max = value;
+    joystick_update_scales(axis);
+  }
+
+  int32_t diff = value - (axis->center_q4 >> 4);
+  int32_t magnitude = diff < 0 ? -diff : diff;
+  if (magnitude <= dead_zone) {
+    // em repouso o centro segue lentamente a leitura (filtro IIR de 1/16 em Q4)
+    axis->center_q4 += value - (axis->center_q4 >> 4);
+    if ((axis->center_q4 >> 4) != axis->scale_center)
+      joystick_update_scales(axis);
+    return axis->out_center;
+  }
+
+  // excursão além da zona morta normalizada em Q12 e limitada a 1.0
+  int32_t scale = diff < 0 ? axis->neg_scale : axis->pos_scale;
+  uint32_t t = ((uint32_t)(magnitude - dead_zone) * scale) >> 16;
+  if (t > 4096)
+    t = 4096;
+
+  // curva de resposta por interpolação linear entre os pontos da tabela
+  uint32_t index = t >> 8;
+  uint32_t shaped = curve[index];
+  if (index < JOYSTICK_CURVE_POINTS - 1)
+    shaped += ((curve[index + 1] - curve[index]) * (t & 0xFF)) >> 8;
+
+  int32_t offset = (shaped * axis->out_range) >> 12;
+  if ((diff < 0) != axis->invert)
+    offset = -offset;
+  return axis->out_center + offset;
+}
+
+// converte as leituras do ADC em coordenadas de tela (centro +- faixa configurada)
+void joystick_map(uint16_t x_value, uint16_t y_value, int *x, int *y) {
+  *x = joystick_map_axis(&axis_x, x_value);
+  *y = joystick_map_axis(&axis_y, y_value);
+}
+
+// conversão antiga de main.c, em float: centro fixo e normalização para [-1, 1]. Mantida só como
+// referência das medições de joystick_map
+void joystick_map_float(uint16_t x_value, uint16_t y_value, int *x, int *y) {
+  int16_t x_diff = x_value - 2049;
+  int16_t y_diff = 1988 - y_value;
+  float normalized_x = (float)x_diff / 2049.0f;
+  float normalized_y = (float)y_diff / 2107.0f;
+  *x = 60 + (int)(normalized_x * 60.0f);
+  *y = 28 + (int)(normalized_y * 28.0f);
+}
+
+#if TRACE_ENABLED
+#define JOYSTICK_MEASURE_CALLS 64
+#define JOYSTICK_MEASURE_ROUNDS 8
+
+typedef void (*joystick_map_fn_t)(uint16_t x_value, uint16_t y_value, int *x, int *y);
+
+// desconta das medições o laço e a chamada indireta
+static void joystick_map_none(uint16_t x_value, uint16_t y_value, int *x, int *y) {
+  *x = x_value;
+  *y = y_value;
+}
+
+// ciclos do SysTick de JOYSTICK_MEASURE_CALLS chamadas varrendo a faixa do ADC com os eixos em
+// sentidos opostos. Fica a menor das rodadas, para descartar as que foram interrompidas
+static uint32_t joystick_measure_map(joystick_map_fn_t map) {
+  volatile int sink = 0;
+  uint32_t best = UINT32_MAX;
+  for (uint round = 0; round < JOYSTICK_MEASURE_ROUNDS; ++round) {
+    uint32_t start = trace_now();
+    for (uint i = 0; i < JOYSTICK_MEASURE_CALLS; ++i) {
+      int x, y;
+      uint16_t value = i * (4096 / JOYSTICK_MEASURE_CALLS);
+      map(value, 4095 - value, &x, &y);
+      sink += x + y;
+    }
+    uint32_t cycles = (start - trace_now()) & TRACE_CYCLES_MASK;
+    if (cycles < best)
+      best = cycles;
+  }
+  return best;
+}
+
+// ciclos por par de eixos de joystick_map e da conversão antiga em float, medidos no núcleo que
+// chama. A varredura passa dos extremos calibrados, então a calibração é restaurada no fim
+void joystick_measure(uint32_t *fixed_cycles, uint32_t *float_cycles) {
+  joystick_axis_t saved_x = axis_x;
+  joystick_axis_t saved_y = axis_y;
+
+  uint32_t overhead = joystick_measure_map(joystick_map_none);
+  uint32_t fixed = joystick_measure_map(joystick_map);
+  uint32_t floating = joystick_measure_map(joystick_map_float);
+  *fixed_cycles = (fixed > overhead ? fixed - overhead : 0) / JOYSTICK_MEASURE_CALLS;
+  *float_cycles = (floating > overhead ? floating - overhead : 0) / JOYSTICK_MEASURE_CALLS;
+
+  axis_x = saved_x;
+  axis_y = saved_y;
+}
+#endif
@@ -0,0 +1,43 @@
+#ifndef JOYSTICK_H
+#define JOYSTICK_H
+
+#include "pico/stdlib.h"
+
+// Captura contínua dos dois eixos do joystick. O ADC alterna sozinho entre os dois canais
+// (round robin) e um canal de DMA copia cada conversão da FIFO para um buffer circular, sem
+// custo de CPU por amostra. A leitura devolve a média das amostras recentes de cada eixo.
+
+#define JOYSTICK_SAMPLE_RATE_HZ 8000 // conversões por segundo, somando os dois eixos
+#define JOYSTICK_RING_BITS 8 // buffer circular de 2^8 bytes = 128 amostras (64 por eixo, 16 ms)
+#define JOYSTICK_RING_SAMPLES ((1u << JOYSTICK_RING_BITS) / sizeof(uint16_t))
+
+// Mapeamento das leituras para coordenadas de tela só com aritmética inteira. O centro é medido no
+// boot e acompanhado enquanto o joystick está parado; os extremos começam em 90% da faixa do ADC e
+// crescem quando o potenciômetro vai além deles. A curva de resposta é uma tabela de 17 pontos em
+// Q12 interpolada linearmente.
+#define JOYSTICK_CURVE_POINTS 17
+#define JOYSTICK_DEAD_ZONE_DEFAULT 48 // em contagens do ADC
+
+typedef struct {
+  int32_t center_q4; // centro em Q4 para o ajuste fino em tempo de execução
+  int32_t min, max; // extremos observados
+  int32_t neg_scale, pos_scale; // Q12 da excursão útil de cada lado: (4096 << 16) / (extremo - centro - zona morta), para cima
+  int32_t scale_center; // centro usado no último cálculo das escalas
+  int16_t out_center, out_range;
+  bool invert;
+} joystick_axis_t;
+
+void joystick_init(uint x_pin, uint y_pin);
+void joystick_read(uint16_t *x_value, uint16_t *y_value);
+void joystick_suspend(void);
+void joystick_sample(uint16_t *x_value, uint16_t *y_value);
+void joystick_resume(void);
+
+void joystick_calibrate(void);
+void joystick_set_output(int16_t x_center, int16_t x_range, int16_t y_center, int16_t y_range);
+void joystick_set_response(uint16_t dead_zone, uint8_t expo);
+void joystick_map(uint16_t x_value, uint16_t y_value, int *x, int *y);
+void joystick_map_float(uint16_t x_value, uint16_t y_value, int *x, int *y);
+void joystick_measure(uint32_t *fixed_cycles, uint32_t *float_cycles); // só com TRACE_ENABLED
+
+#endif
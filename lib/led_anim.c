@@ -0,0 +1,215 @@
+#include <string.h>
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "led_anim.h"
+
+#define LED_ANIM_CHANNELS 3
+#define LED_ANIM_ONE (1u << 16) // 1.0 em Q16
+
+// deslocamento de cada canal na palavra GRB do fio
+static const uint8_t channel_shift[LED_ANIM_CHANNELS] = { 24, 16, 8 };
+
+static uint anim_leds;
+static led_anim_ready_t anim_ready;
+static led_anim_begin_t anim_begin;
+static led_anim_end_t anim_end;
+static int anim_alarm;
+static uint64_t anim_next_us;
+static volatile bool anim_running; // o alarme está agendado
+static bool anim_dirty; // led_anim_play trocou o quadro de uma vez e o próximo alarme o envia
+
+// valor atual de cada canal em Q16 e diferença até o alvo do fade em curso
+static int32_t current[LED_ANIM_MAX_LEDS][LED_ANIM_CHANNELS];
+static int16_t delta[LED_ANIM_MAX_LEDS][LED_ANIM_CHANNELS];
+
+// sequência em reprodução; só é alterada com a interrupção do alarme desligada
+static const led_anim_keyframe_t *anim_keys;
+static uint anim_count;
+static uint anim_index;
+static bool anim_loop;
+static uint32_t anim_fade_frames;
+static uint32_t anim_hold_frames;
+static uint32_t anim_frame; // quadro dentro do fade e depois dentro do hold
+static uint32_t anim_progress; // curva de progresso no quadro anterior, Q16
+static bool anim_fading;
+
+// quadro-chave e buffer de led_anim_show
+static led_anim_keyframe_t show_key;
+static uint32_t show_frame[LED_ANIM_MAX_LEDS];
+
+volatile uint32_t led_anim_frames = 0;
+volatile uint32_t led_anim_deferred = 0;
+volatile uint32_t led_anim_tick_max_us = 0;
+
+static uint32_t led_anim_ms_to_frames(uint16_t ms) {
+  return ((uint32_t)ms * 1000 + LED_ANIM_FRAME_US / 2) / LED_ANIM_FRAME_US;
+}
+
+// progresso t (Q16) passado pela curva
+static uint32_t led_anim_ease(led_anim_ease_t ease, uint32_t t) {
+  if (ease == LED_ANIM_EASE_LINEAR)
+    return t;
+  // 3t² - 2t³
+  uint64_t t2 = ((uint64_t)t * t) >> 16;
+  uint64_t t3 = (t2 * t) >> 16;
+  return (uint32_t)(3 * t2 - 2 * t3);
+}
+
+static void led_anim_snap(const uint32_t frame[]) {
+  for (uint i = 0; i < anim_leds; ++i)
+    for (uint c = 0; c < LED_ANIM_CHANNELS; ++c)
+      current[i][c] = (int32_t)((frame[i] >> channel_shift[c]) & 0xFF) << 16;
+}
+
+static void led_anim_output(void) {
+  uint32_t *wire = anim_begin();
+  for (uint i = 0; i < anim_leds; ++i) {
+    uint32_t word = 0;
+    for (uint c = 0; c < LED_ANIM_CHANNELS; ++c)
+      word |= (uint32_t)(current[i][c] >> 16) << channel_shift[c];
+    wire[i] = word;
+  }
+  anim_end();
+  led_anim_frames++;
+}
+
+// começa o fade até o quadro-chave atual, partindo do valor atual de cada LED (mesmo no meio de
+// outro fade, para trocar de alvo sem salto). Sem fade o quadro é copiado e fica para ser enviado
+static void led_anim_start_key(void) {
+  const led_anim_keyframe_t *key = &anim_keys[anim_index];
+  anim_fade_frames = led_anim_ms_to_frames(key->fade_ms);
+  anim_hold_frames = led_anim_ms_to_frames(key->hold_ms);
+  anim_frame = 0;
+  anim_progress = 0;
+
+  if (anim_fade_frames == 0) {
+    led_anim_snap(key->frame);
+    anim_dirty = true;
+    anim_fading = false;
+    return;
+  }
+
+  for (uint i = 0; i < anim_leds; ++i)
+    for (uint c = 0; c < LED_ANIM_CHANNELS; ++c)
+      delta[i][c] = (int16_t)((key->frame[i] >> channel_shift[c]) & 0xFF) - (int16_t)(current[i][c] >> 16);
+  anim_fading = true;
+}
+
+// um quadro; devolve false quando a animação terminou e o alarme pode parar. O quadro alterado é
+// marcado em anim_dirty e enviado pelo alarme
+static bool led_anim_step(void) {
+  const led_anim_keyframe_t *key = &anim_keys[anim_index];
+
+  if (anim_fading) {
+    if (++anim_frame >= anim_fade_frames) {
+      led_anim_snap(key->frame);
+      anim_fading = false;
+      anim_frame = 0;
+    } else {
+      uint32_t progress = led_anim_ease(key->ease, anim_frame * LED_ANIM_ONE / anim_fade_frames);
+      int32_t step = (int32_t)(progress - anim_progress);
+      anim_progress = progress;
+      for (uint i = 0; i < anim_leds; ++i)
+        for (uint c = 0; c < LED_ANIM_CHANNELS; ++c)
+          current[i][c] += delta[i][c] * step;
+    }
+    anim_dirty = true;
+    return true;
+  }
+
+  if (anim_frame++ < anim_hold_frames)
+    return true;
+
+  if (++anim_index == anim_count) {
+    if (!anim_loop || anim_count == 1)
+      return false;
+    anim_index = 0;
+  }
+  led_anim_start_key();
+  return true;
+}
+
+// arma o alarme para target_us; se o alvo já passou, volta a contar delay_us a partir de agora
+static void led_anim_schedule(uint64_t target_us, uint32_t delay_us) {
+  anim_next_us = target_us;
+  while (hardware_alarm_set_target(anim_alarm, from_us_since_boot(anim_next_us)))
+    anim_next_us = time_us_64() + delay_us;
+}
+
+// interrupção do alarme, no núcleo que chamou led_anim_init. Com o envio anterior em andamento a
+// animação não avança e o alarme volta logo depois. Um quadro trocado por led_anim_play sai antes
+// de a animação avançar
+static void led_anim_alarm_callback(uint alarm_num) {
+  (void)alarm_num;
+  uint32_t start_us = time_us_32();
+
+  if (!anim_ready()) {
+    led_anim_deferred++;
+    led_anim_schedule(time_us_64() + LED_ANIM_RETRY_US, LED_ANIM_RETRY_US);
+  } else {
+    bool running = anim_dirty || led_anim_step();
+    if (anim_dirty) {
+      anim_dirty = false;
+      led_anim_output();
+    }
+    if (running)
+      led_anim_schedule(anim_next_us + LED_ANIM_FRAME_US, LED_ANIM_FRAME_US);
+    else
+      anim_running = false;
+  }
+
+  uint32_t elapsed_us = time_us_32() - start_us;
+  if (elapsed_us > led_anim_tick_max_us)
+    led_anim_tick_max_us = elapsed_us;
+}
+
+// o alarme interrompe o núcleo que chama led_anim_init; as demais funções devem ser chamadas nele.
+// A matriz deve estar apagada: o estado inicial dos fades é tudo em 0
+void led_anim_init(uint led_count, led_anim_ready_t ready, led_anim_begin_t begin, led_anim_end_t end) {
+  anim_leds = led_count < LED_ANIM_MAX_LEDS ? led_count : LED_ANIM_MAX_LEDS;
+  anim_ready = ready;
+  anim_begin = begin;
+  anim_end = end;
+  anim_running = false;
+  anim_dirty = false;
+  memset(current, 0, sizeof(current));
+
+  anim_alarm = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(anim_alarm, led_anim_alarm_callback);
+}
+
+// substitui a animação atual pela sequência, começando pelo fade até o primeiro quadro-chave. keys e
+// os quadros precisam existir até o fim da reprodução; com loop, o último volta ao primeiro. Não
+// envia nada: um quadro sem fade sai no alarme, antecipado para daqui a LED_ANIM_RETRY_US
+void led_anim_play(const led_anim_keyframe_t keys[], uint count, bool loop) {
+  if (count == 0)
+    return;
+
+  uint32_t status = save_and_disable_interrupts();
+  anim_keys = keys;
+  anim_count = count;
+  anim_index = 0;
+  anim_loop = loop;
+  led_anim_start_key();
+
+  if (anim_dirty)
+    led_anim_schedule(time_us_64() + LED_ANIM_RETRY_US, LED_ANIM_RETRY_US);
+  else if (!anim_running)
+    led_anim_schedule(time_us_64() + LED_ANIM_FRAME_US, LED_ANIM_FRAME_US);
+  anim_running = true;
+  restore_interrupts(status);
+}
+
+// fade até um único quadro, copiado: o chamador pode reutilizar frame logo em seguida
+void led_anim_show(const uint32_t frame[], uint16_t fade_ms, led_anim_ease_t ease) {
+  uint32_t status = save_and_disable_interrupts();
+  memcpy(show_frame, frame, anim_leds * sizeof(uint32_t));
+  show_key = (led_anim_keyframe_t){ .frame = show_frame, .fade_ms = fade_ms, .hold_ms = 0, .ease = ease };
+  led_anim_play(&show_key, 1, false);
+  restore_interrupts(status);
+}
+
+// ainda há fade ou sequência em andamento
+bool led_anim_busy(void) {
+  return anim_running;
+}
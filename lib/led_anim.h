@@ -0,0 +1,51 @@
+#ifndef LED_ANIM_H
+#define LED_ANIM_H
+
+#include "pico/stdlib.h"
+
+// Animação da matriz de LEDs por quadros-chave. Um alarme de hardware marca quadros a LED_ANIM_FPS
+// e, a cada quadro, avança o cross-fade de todos os LEDs e envia o resultado sozinho; o laço da
+// aplicação só escolhe o que tocar. Quando nada está mudando o alarme para e a matriz não é reescrita.
+// Só o alarme escreve na matriz, e nunca espera: se o envio anterior ainda não terminou, o quadro
+// é adiado por LED_ANIM_RETRY_US sem avançar a animação.
+//
+// O fade é incremental em ponto fixo: cada canal guarda o valor atual em Q16 e a diferença até o
+// alvo, e a cada quadro soma diferença * (incremento da curva de progresso). A curva (linear ou
+// suavizada) é calculada uma vez por quadro para todos os LEDs. No fim do fade o valor vai
+// exatamente para o alvo, sem erro acumulado.
+//
+// Os quadros são palavras GRB na ordem do fio, com o brilho já aplicado, como em matrizWriteFrame.
+
+#define LED_ANIM_FPS 100
+#define LED_ANIM_FRAME_US (1000000 / LED_ANIM_FPS)
+#define LED_ANIM_RETRY_US 100
+#define LED_ANIM_MAX_LEDS 25
+
+typedef enum {
+  LED_ANIM_EASE_LINEAR,
+  LED_ANIM_EASE_IN_OUT, // smoothstep: começa e termina devagar
+} led_anim_ease_t;
+
+typedef struct {
+  const uint32_t *frame;
+  uint16_t fade_ms; // cross-fade a partir do que está na matriz; 0 troca de uma vez
+  uint16_t hold_ms; // tempo parado no quadro antes do próximo
+  led_anim_ease_t ease;
+} led_anim_keyframe_t;
+
+// destino dos quadros: ready diz se o envio anterior terminou; só então begin devolve o buffer do fio
+// e end dispara o envio, os dois sem esperar
+typedef bool (*led_anim_ready_t)(void);
+typedef uint32_t *(*led_anim_begin_t)(void);
+typedef void (*led_anim_end_t)(void);
+
+void led_anim_init(uint led_count, led_anim_ready_t ready, led_anim_begin_t begin, led_anim_end_t end);
+void led_anim_play(const led_anim_keyframe_t keys[], uint count, bool loop);
+void led_anim_show(const uint32_t frame[], uint16_t fade_ms, led_anim_ease_t ease);
+bool led_anim_busy(void);
+
+extern volatile uint32_t led_anim_frames; // quadros enviados
+extern volatile uint32_t led_anim_deferred; // quadros adiados com o envio anterior em andamento
+extern volatile uint32_t led_anim_tick_max_us;
+
+#endif
@@ -1,14 +1,24 @@
+#include <string.h>
 #include "pico/stdlib.h"
-#include "hardware/pio.h"
-#include "hardware/clocks.h"
-#include "ws2818b.pio.h"
+#include "ws2812.h"
 
-// Definição do número de LEDs e pino.
-#define LED_COUNT 25
+// Geometria da matriz da placa: um único painel 5x5 numa fita, em serpentina, com o primeiro LED no
+// canto inferior direito. Paredes maiores só mudam esta configuração (ver ws2812.h).
+#define LED_COLUMNS 5
+#define LED_ROWS 5
+#define LED_COUNT (LED_COLUMNS * LED_ROWS)
 #define LED_PIN 7
 
+static const ws2812_config_t np_config = {
+  .tile = { .columns = LED_COLUMNS, .rows = LED_ROWS, .serpentine = true, .flip_x = true, .flip_y = true },
+  .tiles = { .columns = 1, .rows = 1 },
+  .strips = 1,
+};
+
 // Global brightness setting (0-255, default is full brightness)
 uint8_t global_brightness = 128;
+// valor de cada componente (0-255) já escalado pelo global_brightness
+uint8_t np_brightness_lut[256];
 
 // Definição de pixel GRB
 struct pixel_t {
@@ -17,26 +27,30 @@ struct pixel_t {
 typedef struct pixel_t pixel_t;
 typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
 
-PIO np_pio;
-uint sm;
+// driver da matriz; o buffer do fio tem uma palavra GRB por LED, alinhada nos bits 31..8
+ws2812_t np_matrix;
 
 // Function to set the global brightness
 void setBrightness(uint8_t brightness) {
     global_brightness = brightness;
+    for (uint i = 0; i < 256; ++i)
+      np_brightness_lut[i] = (i * (global_brightness + 1)) >> 8;
+}
+
+// Aplica o brilho a uma palavra GRB na ordem do fio.
+static inline uint32_t npScaleWord(uint32_t grb) {
+  return ((uint32_t)np_brightness_lut[grb >> 24] << 24) |
+         ((uint32_t)np_brightness_lut[(grb >> 16) & 0xFF] << 16) |
+         ((uint32_t)np_brightness_lut[(grb >> 8) & 0xFF] << 8);
 }
 
 // Inicializa a matriz de LEDs.
 void matrizInit(uint pin, npLED_t leds[]) {
-  uint offset = pio_add_program(pio0, &ws2818b_program);
-  np_pio = pio0;
-
-  sm = pio_claim_unused_sm(np_pio, false);
-  if (sm < 0) {
-    np_pio = pio1;
-    sm = pio_claim_unused_sm(np_pio, true); 
-  }
+  setBrightness(global_brightness);
 
-    ws2818b_program_init(np_pio, sm, offset, pin, 800000.f);
+  ws2812_config_t config = np_config;
+  config.base_pin = pin;
+  ws2812_init(&np_matrix, &config);
 
   for (uint i = 0; i < LED_COUNT; ++i) {
     leds[i].R = 0;
@@ -58,18 +72,46 @@ void npClear(npLED_t leds[]) {
     setMatrizLED(i, 0, 0, 0, leds);
 }
 
-// Escreve o buffer de pixels na matriz.    
+// Indica se o último quadro já saiu pelo fio e o tempo de reset já passou.
+bool matrizReady() {
+  return ws2812_ready(&np_matrix);
+}
+
+void matrizWait() {
+  ws2812_wait(&np_matrix);
+}
+
+// Escreve o buffer de pixels na matriz. Retorna logo após disparar o DMA; só espera se o quadro
+// anterior ainda estiver sendo transmitido.
 void matrizWrite(npLED_t leds[]) {
+  uint32_t *wire = ws2812_begin_frame(&np_matrix);
+
   for (uint i = 0; i < LED_COUNT; ++i) {
     // Scale each color component by the global brightness
-    uint8_t g = (leds[i].G * (global_brightness + 1)) >> 8;
-    uint8_t r = (leds[i].R * (global_brightness + 1)) >> 8;
-    uint8_t b = (leds[i].B * (global_brightness + 1)) >> 8;
-    
-    pio_sm_put_blocking(np_pio, sm, g);
-    pio_sm_put_blocking(np_pio, sm, r);
-    pio_sm_put_blocking(np_pio, sm, b);
+    uint32_t g = np_brightness_lut[leds[i].G];
+    uint32_t r = np_brightness_lut[leds[i].R];
+    uint32_t b = np_brightness_lut[leds[i].B];
+
+    wire[i] = (g << 24) | (r << 16) | (b << 8);
   }
+
+  ws2812_end_frame(&np_matrix);
+}
+
+// Devolve o buffer do fio para ser preenchido direto (na ordem do fio e com o brilho aplicado),
+// depois de esperar o quadro anterior sair se o DMA lê dele. O quadro só é enviado em matrizEndFrame.
+uint32_t *matrizBeginFrame() {
+  return ws2812_begin_frame(&np_matrix);
+}
+
+void matrizEndFrame() {
+  ws2812_end_frame(&np_matrix);
+}
+
+// Envia um quadro que já está na ordem do fio e com o brilho aplicado (ver npScaleWord).
+void matrizWriteFrame(const uint32_t frame[]) {
+  memcpy(matrizBeginFrame(), frame, LED_COUNT * sizeof(uint32_t));
+  matrizEndFrame();
 }
 
 void turnOffLEDs(npLED_t leds[]) {
@@ -79,21 +121,7 @@ void turnOffLEDs(npLED_t leds[]) {
   matrizWrite(leds);
 }
 
+// posição no fio do LED da coluna x e linha y, pela tabela montada na inicialização
 int getIndex(int x, int y) {
-    // Se a linha for par (0, 2, 4), percorremos da esquerda para a direita.
-    // Se a linha for ímpar (1, 3), percorremos da direita para a esquerda.
-    if (y % 2 == 0) {
-        return 24-(y * 5 + x); // Linha par (esquerda para direita).
-    } else {
-        return 24-(y * 5 + (4 - x)); // Linha ímpar (direita para esquerda).
-    }
+  return ws2812_index(&np_matrix, x, y);
 }
-
-void spriteWrite(int matriz[5][5][3], npLED_t leds[]) { 
-  for(int linha = 0; linha < 5; linha++){
-    for(int coluna = 0; coluna < 5; coluna++){
-      int posicao = getIndex(linha, coluna);
-      setMatrizLED(posicao, matriz[coluna][linha][0], matriz[coluna][linha][1], matriz[coluna][linha][2], leds);
-    }
-  }
-}
\ No newline at end of file
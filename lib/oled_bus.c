@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include "oled_bus.h"
+
+void oled_bus_init(oled_bus_t *bus, i2c_inst_t *i2c, uint baudrate) {
+  *bus = (oled_bus_t){ .i2c = i2c, .baudrate = baudrate, .active = -1, .report_time_us = time_us_64() };
+}
+
+// registra um display já iniciado neste barramento; devolve o índice usado nos pedidos ou -1
+int oled_bus_add(oled_bus_t *bus, ssd1306_t *ssd, uint8_t priority) {
+  if (bus->count == OLED_BUS_MAX_DEVICES || ssd->i2c_port != bus->i2c)
+    return -1;
+  bus->devices[bus->count] = (oled_bus_device_t){ .ssd = ssd, .priority = priority };
+  return bus->count++;
+}
+
+// pede o envio do quadro atual do display. Um pedido ainda pendente é reaproveitado: o envio leva o
+// conteúdo do momento em que começar, e vale o prazo mais próximo
+void oled_bus_request(oled_bus_t *bus, int device, uint64_t deadline_us) {
+  oled_bus_device_t *dev = &bus->devices[device];
+  if (dev->pending && (int64_t)(dev->deadline_us - deadline_us) <= 0)
+    return;
+  dev->deadline_us = deadline_us;
+  dev->pending = true;
+}
+
+// pedido pendente de maior prioridade e, entre iguais, de prazo mais próximo
+static int oled_bus_next(oled_bus_t *bus) {
+  int next = -1;
+  for (int i = 0; i < bus->count; ++i) {
+    oled_bus_device_t *dev = &bus->devices[i];
+    if (!dev->pending)
+      continue;
+    if (next < 0 || dev->priority < bus->devices[next].priority ||
+        (dev->priority == bus->devices[next].priority && (int64_t)(dev->deadline_us - bus->devices[next].deadline_us) < 0))
+      next = i;
+  }
+  return next;
+}
+
+// avança o barramento: libera o envio que terminou e inicia o próximo pedido. Devolve o instante em
+// que deve ser chamada de novo (em us desde o boot) ou 0 quando não há envio nem pedido pendente
+uint64_t oled_bus_poll(oled_bus_t *bus) {
+  uint64_t now_us = time_us_64();
+  if (bus->active >= 0) {
+    if (ssd1306_flush_busy(bus->devices[bus->active].ssd))
+      return bus->busy_until_us > now_us ? bus->busy_until_us : now_us + OLED_BUS_POLL_US;
+    bus->active = -1;
+  }
+
+  int next;
+  while ((next = oled_bus_next(bus)) >= 0) {
+    oled_bus_device_t *dev = &bus->devices[next];
+    dev->pending = false;
+    if ((int64_t)(now_us - dev->deadline_us) > 0)
+      dev->late++;
+
+    ssd1306_send_data_async(dev->ssd);
+    uint32_t bytes = dev->ssd->stats.frame_bytes;
+    // nada mudou desde o último envio: o barramento continua livre para o próximo pedido
+    if (bytes == 0)
+      continue;
+
+    uint32_t busy_us = (uint64_t)bytes * 9 * 1000000 / bus->baudrate;
+    dev->frames++;
+    dev->bytes += bytes;
+    dev->busy_us += busy_us;
+    bus->active = next;
+    bus->busy_until_us = now_us + busy_us;
+    return bus->busy_until_us;
+  }
+  return 0;
+}
+
+bool oled_bus_idle(oled_bus_t *bus) {
+  return bus->active < 0 && oled_bus_next(bus) < 0;
+}
+
+// imprime, por display, quadros por segundo, bytes por quadro, ocupação do barramento e envios
+// atrasados desde o relatório anterior, e a ocupação total do barramento
+void oled_bus_report(oled_bus_t *bus) {
+  uint64_t now_us = time_us_64();
+  uint32_t window_us = now_us - bus->report_time_us;
+  if (window_us == 0)
+    return;
+  bus->report_time_us = now_us;
+
+  uint32_t total_busy_us = 0;
+  for (int i = 0; i < bus->count; ++i) {
+    oled_bus_device_t *dev = &bus->devices[i];
+    uint32_t frames = dev->frames, bytes = dev->bytes, late = dev->late, busy_us = dev->busy_us;
+    uint32_t window_frames = frames - dev->report_frames;
+    uint32_t window_busy_us = busy_us - dev->report_busy_us;
+
+    printf("OLED 0x%02x: %u.%u quadros/s | %u bytes/quadro | barramento %u.%u%% | atrasados %u\n",
+      dev->ssd->address,
+      (uint)((uint64_t)window_frames * 1000000 / window_us),
+      (uint)((uint64_t)window_frames * 10000000 / window_us % 10),
+      (uint)(window_frames ? (bytes - dev->report_bytes) / window_frames : 0),
+      (uint)((uint64_t)window_busy_us * 100 / window_us),
+      (uint)((uint64_t)window_busy_us * 1000 / window_us % 10),
+      (uint)(late - dev->report_late));
+
+    total_busy_us += window_busy_us;
+    dev->report_frames = frames;
+    dev->report_bytes = bytes;
+    dev->report_late = late;
+    dev->report_busy_us = busy_us;
+  }
+
+  printf("Barramento I2C%u: ocupado %u.%u%%\n",
+    i2c_hw_index(bus->i2c),
+    (uint)((uint64_t)total_busy_us * 100 / window_us),
+    (uint)((uint64_t)total_busy_us * 1000 / window_us % 10));
+}
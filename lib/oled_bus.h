@@ -0,0 +1,58 @@
+#ifndef OLED_BUS_H
+#define OLED_BUS_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "ssd1306.h"
+
+// Gerenciador de um barramento I2C compartilhado por vários SSD1306 (endereços diferentes). Cada
+// display pede o envio do seu quadro com um prazo; o gerenciador mantém no máximo um envio
+// assíncrono (DMA) em andamento no barramento e, quando ele termina, inicia o pedido pendente de
+// maior prioridade, desempatando pelo prazo mais próximo. Displays em barramentos diferentes usam
+// um gerenciador cada e transmitem em paralelo.
+//
+// Tudo roda no núcleo que desenha: oled_bus_poll não bloqueia e devolve quando precisa ser chamada
+// de novo. Com o gerenciador, o envio dos displays registrados passa só por ele; chamar
+// ssd1306_send_data ou comandos avulsos no meio de um envio de outro display corromperia o barramento.
+//
+// O tempo de barramento é estimado pelos bytes de cada envio (9 bits por byte na frequência do I2C).
+// Os contadores são cumulativos e escritos só pelo núcleo que desenha; o relatório guarda os valores
+// do relatório anterior para imprimir as taxas da janela, então pode rodar no outro núcleo.
+
+#define OLED_BUS_MAX_DEVICES 4
+#define OLED_BUS_POLL_US 50 // nova verificação quando o fim estimado passa e o envio não terminou
+
+typedef struct {
+  ssd1306_t *ssd;
+  uint8_t priority; // 0 é a mais alta
+  volatile bool pending;
+  uint64_t deadline_us;
+
+  // estatísticas cumulativas
+  volatile uint32_t frames; // envios com algum byte
+  volatile uint32_t bytes;
+  volatile uint32_t late; // envios iniciados depois do prazo
+  volatile uint32_t busy_us;
+
+  // valores no relatório anterior
+  uint32_t report_frames, report_bytes, report_late, report_busy_us;
+} oled_bus_device_t;
+
+typedef struct {
+  i2c_inst_t *i2c;
+  uint baudrate;
+  oled_bus_device_t devices[OLED_BUS_MAX_DEVICES];
+  uint8_t count;
+  int active; // display com envio em andamento, -1 com o barramento livre
+  uint64_t busy_until_us; // fim estimado do envio em andamento
+  uint64_t report_time_us;
+} oled_bus_t;
+
+void oled_bus_init(oled_bus_t *bus, i2c_inst_t *i2c, uint baudrate);
+int oled_bus_add(oled_bus_t *bus, ssd1306_t *ssd, uint8_t priority);
+void oled_bus_request(oled_bus_t *bus, int device, uint64_t deadline_us);
+uint64_t oled_bus_poll(oled_bus_t *bus);
+bool oled_bus_idle(oled_bus_t *bus);
+void oled_bus_report(oled_bus_t *bus);
+
+#endif
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "hardware/clocks.h"
+#include "power.h"
+
+void power_init(power_t *power) {
+  uint64_t now = time_us_64();
+  *power = (power_t){ .state = POWER_ACTIVE, .last_activity_us = now, .state_since_us = now };
+}
+
+// houve entrada do usuário: adia a entrada no modo ocioso
+void power_activity(power_t *power) {
+  power->last_activity_us = time_us_64();
+}
+
+bool power_idle_due(power_t *power) {
+  return power->state == POWER_ACTIVE && time_us_64() - power->last_activity_us >= POWER_IDLE_TIMEOUT_MS * 1000ull;
+}
+
+// chamado com as saídas já desligadas e o escalonador parado. Daqui até power_exit_idle nenhum
+// periférico que dependa do clk_sys ou do clk_peri (I2C, PIO, PWM) pode ser usado
+void power_enter_idle(power_t *power, uint16_t rest_x, uint16_t rest_y) {
+  uint64_t now = time_us_64();
+  power->active_us += now - power->state_since_us;
+  power->state_since_us = now;
+  power->state = POWER_IDLE;
+  power->rest_x = rest_x;
+  power->rest_y = rest_y;
+  power->next_poll_us = now + POWER_ADC_POLL_MS * 1000ull;
+
+  // clk_sys e clk_peri passam para o PLL do USB e o PLL do sistema é desligado. O ADC, o USB e o
+  // timer não dependem do clk_sys e seguem funcionando
+  set_sys_clock_48mhz();
+}
+
+// chegou a hora de mais uma amostra do joystick; agenda a seguinte
+bool power_poll_due(power_t *power) {
+  uint64_t now = time_us_64();
+  if (now < power->next_poll_us)
+    return false;
+  power->next_poll_us = now + POWER_ADC_POLL_MS * 1000ull;
+  return true;
+}
+
+// o joystick saiu da posição de repouso
+bool power_adc_moved(power_t *power, uint16_t x_value, uint16_t y_value) {
+  return abs((int)x_value - power->rest_x) > POWER_WAKE_ADC_DELTA ||
+    abs((int)y_value - power->rest_y) > POWER_WAKE_ADC_DELTA;
+}
+
+// volta ao clock normal. Os divisores do I2C, da PIO e do PWM foram calculados para 125 MHz e
+// não mudaram, então voltam a valer sem reconfiguração
+void power_exit_idle(power_t *power, power_wake_t source) {
+  // a latência do despertar inclui a espera pelo travamento do PLL
+  uint64_t now = time_us_64();
+  set_sys_clock_khz(POWER_ACTIVE_KHZ, true);
+
+  power->idle_us += now - power->state_since_us;
+  power->state_since_us = now;
+  power->last_activity_us = now;
+  power->state = POWER_ACTIVE;
+  if (source == POWER_WAKE_INPUT)
+    power->wakes_input++;
+  else
+    power->wakes_adc++;
+
+  power->wake_us = now;
+  power->wake_frame_pending = true;
+}
+
+// primeiro quadro mostrado depois do despertar (core1)
+void power_wake_frame(power_t *power) {
+  if (!power->wake_frame_pending)
+    return;
+  uint32_t latency_us = time_us_64() - power->wake_us;
+  power->wake_latency_us = latency_us;
+  if (latency_us > power->wake_latency_max_us)
+    power->wake_latency_max_us = latency_us;
+  power->wake_frame_pending = false;
+}
+
+// tempos acumulados desde o boot e a corrente média estimada a partir deles
+void power_report(power_t *power) {
+  uint64_t current_us = time_us_64() - power->state_since_us;
+  uint64_t active_us = power->active_us + (power->state == POWER_ACTIVE ? current_us : 0);
+  uint64_t idle_us = power->idle_us + (power->state == POWER_IDLE ? current_us : 0);
+  uint64_t total_us = active_us + idle_us;
+  if (total_us == 0)
+    return;
+
+  // média ponderada em décimos de mA
+  uint32_t average = (active_us * (POWER_ACTIVE_UA / 100) + idle_us * (POWER_IDLE_UA / 100)) / total_us;
+  printf("Energia: ativo %u s, ocioso %u s | corrente media estimada %u.%u mA | despertares: %u por botao, %u pelo joystick | latencia ate o primeiro quadro %u us, max %u us\n",
+    (uint)(active_us / 1000000),
+    (uint)(idle_us / 1000000),
+    (uint)(average / 10),
+    (uint)(average % 10),
+    (uint)power->wakes_input,
+    (uint)power->wakes_adc,
+    (uint)power->wake_latency_us,
+    (uint)power->wake_latency_max_us);
+}
@@ -0,0 +1,57 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "pico/stdlib.h"
+
+// Gerenciador de ociosidade. O laço principal avisa a atividade (botões, movimento do joystick) e,
+// depois de POWER_IDLE_TIMEOUT_MS sem nenhuma, entra no modo ocioso: o chamador desliga display,
+// matriz e buzzer e para o escalonador, e este módulo baixa o clk_sys de 125 MHz para 48 MHz
+// (PLL do sistema desligado, tudo passa a rodar do PLL do USB). O núcleo dorme em WFE até uma
+// borda de botão ou até a amostragem lenta do joystick sair da posição de repouso; o ADC do RP2040
+// não tem comparador com interrupção, então o limiar é conferido a cada POWER_ADC_POLL_MS.
+//
+// O tempo em cada estado é acumulado e, com o consumo típico de cada um, dá a corrente média
+// estimada. A latência do despertar vai do instante em que ele é detectado até o core1 mostrar o
+// primeiro quadro com o display religado.
+
+#define POWER_IDLE_TIMEOUT_MS 30000
+#define POWER_ADC_POLL_MS 100
+#define POWER_WAKE_ADC_DELTA 200 // contagens do ADC longe da posição de repouso
+
+#define POWER_ACTIVE_KHZ 125000
+// consumo estimado da placa em cada estado, em µA: RP2040 a 125 MHz com os dois núcleos (~25 mA),
+// OLED ligado (~10 mA) e matriz com os LEDs apagados (~15 mA de repouso dos WS2812); no ocioso o
+// RP2040 a 48 MHz em WFE (~8 mA), OLED sem charge pump (~10 µA) e a matriz apagada
+#define POWER_ACTIVE_UA 50000
+#define POWER_IDLE_UA 23000
+
+typedef enum { POWER_ACTIVE, POWER_IDLE } power_state_t;
+
+typedef enum { POWER_WAKE_INPUT, POWER_WAKE_ADC } power_wake_t;
+
+typedef struct {
+  power_state_t state;
+  uint64_t last_activity_us;
+  uint64_t state_since_us;
+  uint64_t active_us, idle_us; // tempo acumulado nos estados já encerrados
+  uint16_t rest_x, rest_y; // leitura do joystick ao entrar no ocioso
+  uint64_t next_poll_us;
+
+  // despertares; o instante e a latência são escritos pelo core1 no primeiro quadro
+  uint32_t wakes_input, wakes_adc;
+  volatile uint64_t wake_us;
+  volatile bool wake_frame_pending;
+  volatile uint32_t wake_latency_us, wake_latency_max_us;
+} power_t;
+
+void power_init(power_t *power);
+void power_activity(power_t *power);
+bool power_idle_due(power_t *power);
+void power_enter_idle(power_t *power, uint16_t rest_x, uint16_t rest_y);
+bool power_poll_due(power_t *power);
+bool power_adc_moved(power_t *power, uint16_t x_value, uint16_t y_value);
+void power_exit_idle(power_t *power, power_wake_t source);
+void power_wake_frame(power_t *power);
+void power_report(power_t *power);
+
+#endif
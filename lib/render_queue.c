@@ -0,0 +1,42 @@
+#include "hardware/sync.h"
+#include "render_queue.h"
+
+void render_queue_init(render_queue_t *queue) {
+  *queue = (render_queue_t){ 0 };
+}
+
+// chamada apenas pelo core0. Os índices crescem livremente e a posição é o índice & máscara, então
+// head - tail é sempre a ocupação, mesmo depois de dar a volta no uint32_t
+bool render_queue_push(render_queue_t *queue, const render_snapshot_t *snapshot) {
+  uint32_t head = queue->head;
+  if (head - queue->tail == RENDER_QUEUE_SIZE) {
+    queue->dropped++;
+    return false;
+  }
+
+  queue->slots[head & RENDER_QUEUE_MASK] = *snapshot;
+  // o retrato precisa estar completo na memória antes de o consumidor enxergar o novo head
+  __dmb();
+  queue->head = head + 1;
+  // acorda o core1 se ele estiver parado no __wfe
+  __sev();
+  return true;
+}
+
+// chamada apenas pelo core1. Copia o retrato mais recente e libera de uma vez todas as posições
+// lidas; devolve false se a fila está vazia
+bool render_queue_pop_latest(render_queue_t *queue, render_snapshot_t *snapshot) {
+  uint32_t head = queue->head;
+  uint32_t tail = queue->tail;
+  if (head == tail)
+    return false;
+
+  // lê o slot só depois de ler o head que o publicou
+  __dmb();
+  *snapshot = queue->slots[(head - 1) & RENDER_QUEUE_MASK];
+  queue->skipped += head - tail - 1;
+  // a cópia termina antes de devolver as posições ao produtor
+  __dmb();
+  queue->tail = head;
+  return true;
+}
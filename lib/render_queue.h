@@ -0,0 +1,37 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "pico/stdlib.h"
+
+// Fila de um produtor e um consumidor, sem trava, entre os dois núcleos. O core0 publica a cada
+// quadro um retrato completo do estado (entrada já processada) e o core1, que é o dono do display,
+// da matriz de LEDs e do buzzer, renderiza o retrato mais recente. Como cada retrato é completo, o
+// consumidor pode pular os antigos e o produtor pode descartar um retrato quando a fila está cheia
+// sem perder estado: o próximo já traz tudo.
+
+#define RENDER_QUEUE_SIZE 4 // potência de 2
+#define RENDER_QUEUE_MASK (RENDER_QUEUE_SIZE - 1)
+
+typedef struct {
+  uint32_t frame; // quadro do escalonador que gerou o retrato
+  int16_t square_x, square_y;
+  bool led_rgb_state;
+  uint8_t volume_scale;
+  bool awake; // false pede ao core1 que desligue as saídas para o modo ocioso
+  bool console; // o display mostra o console de comandos em vez do quadrado
+} render_snapshot_t;
+
+typedef struct {
+  render_snapshot_t slots[RENDER_QUEUE_SIZE];
+  volatile uint32_t head; // escrito apenas pelo produtor
+  volatile uint32_t tail; // escrito apenas pelo consumidor
+
+  uint32_t dropped; // retratos descartados pelo produtor com a fila cheia
+  uint32_t skipped; // retratos pulados pelo consumidor por já haver um mais novo
+} render_queue_t;
+
+void render_queue_init(render_queue_t *queue);
+bool render_queue_push(render_queue_t *queue, const render_snapshot_t *snapshot);
+bool render_queue_pop_latest(render_queue_t *queue, render_snapshot_t *snapshot);
+
+#endif
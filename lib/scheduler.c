@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include "hardware/sync.h"
+#include "scheduler.h"
+
+static bool scheduler_tick(repeating_timer_t *timer) {
+  scheduler_t *scheduler = timer->user_data;
+  scheduler->tick_time_us = time_us_64();
+  scheduler->ticks++;
+  return true;
+}
+
+void scheduler_init(scheduler_t *scheduler, uint32_t period_us) {
+  *scheduler = (scheduler_t){ .period_us = period_us };
+  // atraso negativo: o período é medido entre inícios de callback, sem acumular deriva
+  add_repeating_timer_us(-(int64_t)period_us, scheduler_tick, scheduler, &scheduler->timer);
+}
+
+// para as marcas enquanto o sistema está ocioso; o laço não tem quadros para esperar
+void scheduler_stop(scheduler_t *scheduler) {
+  cancel_repeating_timer(&scheduler->timer);
+}
+
+// volta a gerar marcas a partir de agora. As marcas que o timer teria gerado durante a parada não
+// contam como prazos perdidos
+void scheduler_start(scheduler_t *scheduler) {
+  scheduler->frames = scheduler->ticks;
+  add_repeating_timer_us(-(int64_t)scheduler->period_us, scheduler_tick, scheduler, &scheduler->timer);
+}
+
+// há uma marca do timer ainda não consumida por scheduler_wait
+bool scheduler_pending(scheduler_t *scheduler) {
+  return scheduler->ticks != scheduler->frames;
+}
+
+// espera a próxima marca do timer. Se o quadro anterior atrasou e mais de uma marca chegou,
+// as excedentes contam como prazos perdidos e o laço volta a seguir a marca mais recente
+void scheduler_wait(scheduler_t *scheduler) {
+  while (!scheduler_pending(scheduler))
+    __wfe();
+
+  uint32_t ticks = scheduler->ticks;
+  uint64_t tick_time_us = scheduler->tick_time_us;
+  scheduler->missed += ticks - scheduler->frames - 1;
+  scheduler->frames = ticks;
+
+  scheduler->frame_start_us = time_us_64();
+  uint32_t jitter_us = scheduler->frame_start_us - tick_time_us;
+  if (jitter_us > scheduler->jitter_max_us)
+    scheduler->jitter_max_us = jitter_us;
+  scheduler->jitter_sum_us += jitter_us;
+  scheduler->report_frames++;
+}
+
+void scheduler_frame_done(scheduler_t *scheduler) {
+  uint32_t work_us = time_us_64() - scheduler->frame_start_us;
+  if (work_us > scheduler->work_max_us)
+    scheduler->work_max_us = work_us;
+}
+
+// imprime as estatísticas acumuladas e reinicia a janela de medição
+void scheduler_report(scheduler_t *scheduler) {
+  if (scheduler->report_frames == 0)
+    return;
+
+  printf("Quadros: %u (periodo %u us) | jitter medio %u us, max %u us | trabalho max %u us | prazos perdidos: %u\n",
+    (uint)scheduler->report_frames,
+    (uint)scheduler->period_us,
+    (uint)(scheduler->jitter_sum_us / scheduler->report_frames),
+    (uint)scheduler->jitter_max_us,
+    (uint)scheduler->work_max_us,
+    (uint)scheduler->missed);
+
+  scheduler->missed = 0;
+  scheduler->jitter_max_us = 0;
+  scheduler->jitter_sum_us = 0;
+  scheduler->work_max_us = 0;
+  scheduler->report_frames = 0;
+}
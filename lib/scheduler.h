@@ -0,0 +1,33 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "pico/stdlib.h"
+
+// Escalonador de quadros com período fixo. Um repeating timer marca o início de cada quadro e o
+// laço principal espera a marca em vez de usar sleep_ms, então o período não depende do tempo
+// gasto no quadro.
+typedef struct {
+  uint32_t period_us;
+  repeating_timer_t timer;
+  volatile uint32_t ticks; // marcas geradas pelo timer
+  volatile uint64_t tick_time_us; // instante da última marca
+  uint32_t frames; // marcas já consumidas pelo laço
+  uint64_t frame_start_us;
+
+  // estatísticas desde o último scheduler_report
+  uint32_t missed; // marcas perdidas porque o quadro anterior passou do prazo
+  uint32_t jitter_max_us; // atraso entre a marca e o início do quadro
+  uint64_t jitter_sum_us;
+  uint32_t work_max_us; // tempo de trabalho de um quadro
+  uint32_t report_frames;
+} scheduler_t;
+
+void scheduler_init(scheduler_t *scheduler, uint32_t period_us);
+void scheduler_stop(scheduler_t *scheduler);
+void scheduler_start(scheduler_t *scheduler);
+bool scheduler_pending(scheduler_t *scheduler);
+void scheduler_wait(scheduler_t *scheduler);
+void scheduler_frame_done(scheduler_t *scheduler);
+void scheduler_report(scheduler_t *scheduler);
+
+#endif
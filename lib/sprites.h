@@ -1,90 +0,0 @@
-uint32_t matrix_sprites[11][25] = {
-    // Number 0
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 1
-    {
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000
-    },
-    // Number 2
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0x00000000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 3
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 4
-    {
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000
-    },
-    // Number 5
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0x00000000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 6
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0x00000000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 7
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000
-    },
-    // Number 8
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 9
-    {
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0x00000000, 0x00000000, 0xFFFF0000, 0x00000000,
-        0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000, 0x00000000
-    },
-    // Number 10
-    {
-        0xFFFF0000, 0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000,
-        0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000,
-        0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000,
-        0xFFFF0000, 0x00000000, 0xFFFF0000, 0x00000000, 0xFFFF0000,
-        0xFFFF0000, 0x00000000, 0xFFFF0000, 0xFFFF0000, 0xFFFF0000
-    }
-};
\ No newline at end of file
@@ -1,5 +1,59 @@
+#include <string.h>
 #include "ssd1306.h"
-#include "font.h"
+#include "assets.h"
+
+// custo fixo de uma janela: a transação de endereçamento (endereço, 0x00 e 6 comandos)
+// mais o endereço e o byte de controle da transação de dados
+#define SSD1306_WINDOW_OVERHEAD (8 + 2)
+
+typedef struct {
+  uint8_t x0, x1, p0, p1;
+} ssd1306_window_t;
+
+static inline void ssd1306_mark_column(ssd1306_t *ssd, uint8_t x, uint8_t page) {
+  if (x < ssd->dirty_x0[page])
+    ssd->dirty_x0[page] = x;
+  if (x > ssd->dirty_x1[page])
+    ssd->dirty_x1[page] = x;
+}
+
+static inline bool ssd1306_page_dirty(ssd1306_t *ssd, uint8_t page) {
+  return ssd->dirty_x0[page] <= ssd->dirty_x1[page];
+}
+
+static void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  memset(ssd->dirty_x0, 0xFF, sizeof(ssd->dirty_x0));
+  memset(ssd->dirty_x1, 0x00, sizeof(ssd->dirty_x1));
+  ssd->force_refresh = false;
+}
+
+// reduz a faixa suja de cada página às colunas que diferem do que já está no display.
+// Apagar e redesenhar o mesmo conteúdo (borda, textos fixos) não gera tráfego
+static void ssd1306_trim_dirty(ssd1306_t *ssd) {
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    if (!ssd1306_page_dirty(ssd, page))
+      continue;
+
+    const uint8_t *current = &ssd->frame_buffer[page + 1];
+    const uint8_t *sent = &ssd->sent_buffer[page + 1];
+    uint8_t x0 = ssd->dirty_x0[page];
+    uint8_t x1 = ssd->dirty_x1[page];
+
+    while (x0 <= x1 && current[x0 << 3] == sent[x0 << 3])
+      ++x0;
+    if (x0 > x1) {
+      ssd->dirty_x0[page] = 0xFF;
+      ssd->dirty_x1[page] = 0x00;
+      continue;
+    }
+    // a coluna x0 difere, então o laço abaixo sempre para nela ou antes
+    while (current[x1 << 3] == sent[x1 << 3])
+      --x1;
+
+    ssd->dirty_x0[page] = x0;
+    ssd->dirty_x1[page] = x1;
+  }
+}
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,40 +62,60 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
-  ssd->ram_buffer[0] = 0x40;
+  ssd->background_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->background_buffer[0] = 0x40;
+  ssd->ram_buffer = ssd->background_buffer;
+  ssd->frame_buffer = ssd->background_buffer;
+  ssd->layer_count = 0;
   ssd->port_buffer[0] = 0x80;
+  ssd->window_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->window_buffer[0] = 0x40;
+  ssd->sent_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->front_buffer = calloc(SSD1306_FRONT_WORDS(ssd->bufsize), sizeof(uint16_t));
+  ssd->front_len = 0;
+  ssd->dma_channel = -1;
+  ssd->flush_pending = false;
+  ssd->start_line = 0;
+  ssd->start_line_pending = false;
+  ssd->stats = (ssd1306_stats_t){0};
+  ssd1306_clear_dirty(ssd);
+  // o conteúdo da RAM do controlador é indefinido após o reset
+  ssd1306_mark_all_dirty(ssd);
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  const uint8_t commands[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, HEIGHT - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, 0x14,
+    SET_DISP | 0x01
+  };
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+}
+
+// desliga o painel e o charge pump (modo sleep, poucos µA) ou os religa. A GDDRAM é mantida
+// enquanto o controlador está alimentado, então o conteúdo volta sem reenvio
+void ssd1306_power(ssd1306_t *ssd, bool on) {
+  // o painel é apagado antes de desligar o charge pump e só é aceso depois de religá-lo
+  const uint8_t off_commands[] = { SET_DISP | 0x00, SET_CHARGE_PUMP, 0x10 };
+  const uint8_t on_commands[] = { SET_CHARGE_PUMP, 0x14, SET_DISP | 0x01 };
+  ssd1306_command_list(ssd, on ? on_commands : off_commands, 3);
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_flush_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -50,59 +124,424 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
     2,
     false
   );
+  ssd->stats.frame_bytes += 3;
+  ssd->stats.frame_transactions++;
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
+// envia uma sequência de comandos numa única transação: com o byte de controle 0x00 (Co = 0)
+// todos os bytes seguintes são interpretados como comandos
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t len) {
+  uint8_t buffer[SSD1306_MAX_COMMANDS + 1];
+  while (len > 0) {
+    size_t chunk = len > SSD1306_MAX_COMMANDS ? SSD1306_MAX_COMMANDS : len;
+    buffer[0] = 0x00;
+    memcpy(&buffer[1], commands, chunk);
+
+    ssd1306_flush_wait(ssd);
+    i2c_write_blocking(
+      ssd->i2c_port,
+      ssd->address,
+      buffer,
+      chunk + 1,
+      false
+    );
+    ssd->stats.frame_bytes += chunk + 2;
+    ssd->stats.frame_transactions++;
+
+    commands += chunk;
+    len -= chunk;
+  }
+}
+
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1) {
+  if (x0 >= ssd->width || y0 >= ssd->height)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+
+  for (uint8_t page = y0 >> 3; page <= (y1 >> 3); ++page) {
+    ssd1306_mark_column(ssd, x0, page);
+    ssd1306_mark_column(ssd, x1, page);
+  }
+}
+
+void ssd1306_mark_all_dirty(ssd1306_t *ssd) {
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, 0, ssd->height - 1);
+  ssd->force_refresh = true;
+}
+
+// rola a imagem inteira por hardware: a linha `line` da GDDRAM passa a ser a primeira da tela. Só
+// muda o mapeamento na exibição; o ram_buffer e as janelas continuam em coordenadas da GDDRAM
+void ssd1306_set_start_line(ssd1306_t *ssd, uint8_t line) {
+  line %= ssd->height;
+  if (line == ssd->start_line && !ssd->start_line_pending)
+    return;
+  ssd->start_line = line;
+  ssd->start_line_pending = true;
+}
+
+// registra uma camada por cima das já existentes. A primeira camada separa o frame_buffer do fundo
+bool ssd1306_layer_add(ssd1306_t *ssd, ssd1306_layer_t *layer, ssd1306_blend_t blend) {
+  if (ssd->layer_count == SSD1306_MAX_LAYERS)
+    return false;
+
+  if (ssd->frame_buffer == ssd->background_buffer) {
+    ssd->frame_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    memcpy(ssd->frame_buffer, ssd->background_buffer, ssd->bufsize);
+  }
+
+  layer->buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  layer->blend = blend;
+  layer->visible = true;
+  ssd->layers[ssd->layer_count++] = layer;
+  return true;
+}
+
+// direciona as funções de desenho para a camada; NULL volta ao fundo. As colunas desenhadas
+// ficam sujas no display como um todo, qualquer que seja a camada
+void ssd1306_layer_select(ssd1306_t *ssd, ssd1306_layer_t *layer) {
+  ssd->ram_buffer = layer ? layer->buffer : ssd->background_buffer;
+}
+
+void ssd1306_layer_set_visible(ssd1306_t *ssd, ssd1306_layer_t *layer, bool visible) {
+  if (layer->visible == visible)
+    return;
+  layer->visible = visible;
+  // o trim reduz a faixa às colunas em que a camada realmente tinha conteúdo
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, 0, ssd->height - 1);
+}
+
+// recompõe o frame_buffer nas colunas sujas: fundo, depois cada camada visível em ordem
+static void ssd1306_compose(ssd1306_t *ssd) {
+  if (ssd->layer_count == 0)
+    return;
+
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    if (!ssd1306_page_dirty(ssd, page))
+      continue;
+
+    uint16_t end = (ssd->dirty_x1[page] << 3) + page + 1;
+    for (uint16_t i = (ssd->dirty_x0[page] << 3) + page + 1; i <= end; i += 8) {
+      uint8_t value = ssd->background_buffer[i];
+      for (uint8_t l = 0; l < ssd->layer_count; ++l) {
+        const ssd1306_layer_t *layer = ssd->layers[l];
+        if (!layer->visible)
+          continue;
+        if (layer->blend == SSD1306_BLEND_OR)
+          value |= layer->buffer[i];
+        else
+          value &= ~layer->buffer[i];
+      }
+      ssd->frame_buffer[i] = value;
+    }
+  }
+}
+
+// agrupa as páginas sujas em janelas [x0, x1] x [p0, p1] e limpa o estado de sujeira
+static uint8_t ssd1306_plan_windows(ssd1306_t *ssd, ssd1306_window_t windows[]) {
+  ssd1306_compose(ssd);
+  if (!ssd->force_refresh)
+    ssd1306_trim_dirty(ssd);
+
+  uint8_t count = 0;
+  uint8_t page = 0;
+  while (page < ssd->pages) {
+    if (!ssd1306_page_dirty(ssd, page)) {
+      ++page;
+      continue;
+    }
+
+    // agrupa as páginas sujas vizinhas enquanto a janela unida custar menos que enviá-las separadas
+    uint8_t p0 = page;
+    uint8_t x0 = ssd->dirty_x0[page];
+    uint8_t x1 = ssd->dirty_x1[page];
+    while (page + 1 < ssd->pages && ssd1306_page_dirty(ssd, page + 1)) {
+      uint8_t next_x0 = ssd->dirty_x0[page + 1];
+      uint8_t next_x1 = ssd->dirty_x1[page + 1];
+      uint8_t merged_x0 = next_x0 < x0 ? next_x0 : x0;
+      uint8_t merged_x1 = next_x1 > x1 ? next_x1 : x1;
+
+      uint32_t merged = (merged_x1 - merged_x0 + 1) * (page + 2 - p0);
+      uint32_t split = (x1 - x0 + 1) * (page + 1 - p0) + (next_x1 - next_x0 + 1) + SSD1306_WINDOW_OVERHEAD;
+      if (merged > split)
+        break;
+
+      x0 = merged_x0;
+      x1 = merged_x1;
+      ++page;
+    }
+
+    windows[count++] = (ssd1306_window_t){ x0, x1, p0, page };
+    ++page;
+  }
+
+  ssd1306_clear_dirty(ssd);
+  return count;
+}
+
+// copia a janela para window_buffer (após o byte de controle 0x40) e atualiza a cópia do display.
+// No modo de endereçamento vertical o controlador percorre as páginas de cada coluna antes de
+// avançar a coluna, o mesmo layout do ram_buffer
+static size_t ssd1306_gather_window(ssd1306_t *ssd, const ssd1306_window_t *window) {
+  size_t len = 1;
+  for (uint16_t x = window->x0; x <= window->x1; ++x) {
+    const uint8_t *column = &ssd->frame_buffer[(x << 3) + 1];
+    uint8_t *sent = &ssd->sent_buffer[(x << 3) + 1];
+    for (uint8_t page = window->p0; page <= window->p1; ++page) {
+      ssd->window_buffer[len++] = column[page];
+      sent[page] = column[page];
+    }
+  }
+  return len;
+}
+
+static void ssd1306_window_commands(const ssd1306_window_t *window, uint8_t commands[6]) {
+  commands[0] = SET_COL_ADDR;
+  commands[1] = window->x0;
+  commands[2] = window->x1;
+  commands[3] = SET_PAGE_ADDR;
+  commands[4] = window->p0;
+  commands[5] = window->p1;
+}
+
+static void ssd1306_send_window(ssd1306_t *ssd, const ssd1306_window_t *window) {
+  uint8_t commands[6];
+  ssd1306_window_commands(window, commands);
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+
+  const uint8_t *data = ssd->frame_buffer;
+  size_t len = ssd->bufsize;
+  if (window->x0 != 0 || window->x1 != ssd->width - 1 || window->p0 != 0 || window->p1 != ssd->pages - 1) {
+    len = ssd1306_gather_window(ssd, window);
+    data = ssd->window_buffer;
+  } else {
+    memcpy(ssd->sent_buffer, ssd->frame_buffer, ssd->bufsize);
+  }
+
   i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
+    data,
+    len,
     false
   );
+  ssd->stats.frame_bytes += len + 1;
+  ssd->stats.frame_transactions++;
+}
+
+static void ssd1306_begin_frame_stats(ssd1306_t *ssd) {
+  ssd->stats.frame_bytes = 0;
+  ssd->stats.frame_transactions = 0;
+}
+
+static void ssd1306_end_frame_stats(ssd1306_t *ssd) {
+  ssd->stats.frames++;
+  ssd->stats.total_bytes += ssd->stats.frame_bytes;
+  ssd->stats.total_transactions += ssd->stats.frame_transactions;
+}
+
+void ssd1306_send_data(ssd1306_t *ssd) {
+  ssd1306_flush_wait(ssd);
+  ssd1306_begin_frame_stats(ssd);
+
+  ssd1306_window_t windows[SSD1306_MAX_PAGES];
+  uint8_t count = ssd1306_plan_windows(ssd, windows);
+  for (uint8_t i = 0; i < count; ++i)
+    ssd1306_send_window(ssd, &windows[i]);
+
+  // a rolagem vai depois dos dados, para a linha nova já estar na GDDRAM quando entrar na tela
+  if (ssd->start_line_pending) {
+    ssd->start_line_pending = false;
+    ssd1306_command(ssd, SET_DISP_START_LINE | ssd->start_line);
+  }
+
+  ssd1306_end_frame_stats(ssd);
+}
+
+// acrescenta uma transação ao front_buffer. Cada palavra é escrita direto no IC_DATA_CMD,
+// então o último byte carrega o bit de STOP
+static void ssd1306_queue_transaction(ssd1306_t *ssd, const uint8_t *src, size_t len) {
+  uint16_t *dst = &ssd->front_buffer[ssd->front_len];
+  for (size_t i = 0; i < len; ++i)
+    dst[i] = src[i];
+  dst[len - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+  ssd->front_len += len;
+  ssd->stats.frame_bytes += len + 1;
+  ssd->stats.frame_transactions++;
+}
+
+static void ssd1306_dma_init(ssd1306_t *ssd) {
+  ssd->dma_channel = dma_claim_unused_channel(true);
+
+  dma_channel_config config = dma_channel_get_default_config(ssd->dma_channel);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+  channel_config_set_read_increment(&config, true);
+  channel_config_set_write_increment(&config, false);
+  channel_config_set_dreq(&config, i2c_get_dreq(ssd->i2c_port, true));
+
+  dma_channel_configure(
+    ssd->dma_channel,
+    &config,
+    &i2c_get_hw(ssd->i2c_port)->data_cmd,
+    ssd->front_buffer,
+    0,
+    false
+  );
+}
+
+void ssd1306_send_data_async(ssd1306_t *ssd) {
+  ssd1306_flush_wait(ssd);
+  if (ssd->dma_channel < 0)
+    ssd1306_dma_init(ssd);
+  ssd1306_begin_frame_stats(ssd);
+
+  // troca de buffers: o conteúdo sujo do frame_buffer é codificado no front_buffer, e a partir daqui
+  // o fundo e as camadas podem ser redesenhados enquanto o DMA transmite o quadro
+  ssd->front_len = 0;
+  ssd1306_window_t windows[SSD1306_MAX_PAGES];
+  uint8_t count = ssd1306_plan_windows(ssd, windows);
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t commands[7] = { 0x00 };
+    ssd1306_window_commands(&windows[i], &commands[1]);
+    ssd1306_queue_transaction(ssd, commands, sizeof(commands));
+    ssd1306_queue_transaction(ssd, ssd->window_buffer, ssd1306_gather_window(ssd, &windows[i]));
+  }
+  if (ssd->start_line_pending) {
+    uint8_t commands[2] = { 0x00, SET_DISP_START_LINE | ssd->start_line };
+    ssd->start_line_pending = false;
+    ssd1306_queue_transaction(ssd, commands, sizeof(commands));
+  }
+
+  ssd1306_end_frame_stats(ssd);
+  if (ssd->front_len == 0)
+    return;
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+
+  ssd->flush_pending = true;
+  dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->front_buffer, ssd->front_len);
+}
+
+bool ssd1306_flush_busy(ssd1306_t *ssd) {
+  if (!ssd->flush_pending)
+    return false;
+  if (dma_channel_is_busy(ssd->dma_channel))
+    return true;
+
+  // o DMA termina ao colocar a última palavra na FIFO; o quadro só acabou quando a FIFO esvazia
+  // e o mestre volta ao repouso
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS))
+    return true;
+
+  // um NACK aborta a transmissão e descarta a FIFO até o abort ser limpo
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+    hw->clr_tx_abrt;
+
+  ssd->flush_pending = false;
+  return false;
+}
+
+void ssd1306_flush_wait(ssd1306_t *ssd) {
+  while (ssd1306_flush_busy(ssd))
+    tight_loop_contents();
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
+  ssd1306_mark_column(ssd, x, y >> 3);
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+// preenche o retângulo [x0, x1] x [y0, y1] (inclusivo, já recortado na tela) byte a byte.
+// Cada coluna guarda suas páginas em bytes consecutivos, então a faixa vertical vira uma máscara
+// na primeira página, bytes inteiros no meio e uma máscara na última página
+static void ssd1306_fill_span(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool value) {
+  uint8_t p0 = y0 >> 3;
+  uint8_t p1 = y1 >> 3;
+  uint8_t top_mask = 0xFF << (y0 & 0b111);
+  uint8_t bottom_mask = 0xFF >> (7 - (y1 & 0b111));
+
+  ssd1306_mark_dirty(ssd, x0, x1, y0, y1);
+
+  uint8_t *column = &ssd->ram_buffer[(x0 << 3) + 1];
+  uint8_t *end = &ssd->ram_buffer[(x1 << 3) + 1];
+
+  // faixa dentro de uma única página (linhas horizontais): um byte por coluna
+  if (p0 == p1) {
+    uint8_t mask = top_mask & bottom_mask;
+    if (value) {
+      for (; column <= end; column += 8)
+        column[p0] |= mask;
+    } else {
+      for (; column <= end; column += 8)
+        column[p0] &= ~mask;
     }
+    return;
+  }
+
+  uint8_t middle = value ? 0xFF : 0x00;
+  for (; column <= end; column += 8) {
+    if (value) {
+      column[p0] |= top_mask;
+      column[p1] |= bottom_mask;
+    } else {
+      column[p0] &= ~top_mask;
+      column[p1] &= ~bottom_mask;
+    }
+    for (uint8_t page = p0 + 1; page < p1; ++page)
+      column[page] = middle;
+  }
+}
+
+// recorta a faixa na tela antes de preencher; retorna sem desenhar se ela ficar vazia
+static void ssd1306_clip_span(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+  if (x0 < 0)
+    x0 = 0;
+  if (y0 < 0)
+    y0 = 0;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+
+  ssd1306_fill_span(ssd, x0, x1, y0, y1, value);
+}
+
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  memset(&ssd->ram_buffer[1], value ? 0xFF : 0x00, ssd->bufsize - 1);
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, 0, ssd->height - 1);
 }
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (width == 0 || height == 0)
+    return;
 
+  int right = left + width - 1;
+  int bottom = top + height - 1;
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    ssd1306_clip_span(ssd, left, right, top, bottom, value);
+    return;
   }
+
+  ssd1306_clip_span(ssd, left, right, top, top, value);
+  ssd1306_clip_span(ssd, left, right, bottom, bottom, value);
+  ssd1306_clip_span(ssd, left, left, top, bottom, value);
+  ssd1306_clip_span(ssd, right, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -134,38 +573,46 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 }
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_clip_span(ssd, x0, x1, y, y, value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_clip_span(ssd, x, x, y0, y1, value);
 }
 
+// As colunas do glifo já estão no formato de página do SSD1306 (bit 0 = linha de cima), então o
+// glifo é expandido da flash e copiado coluna a coluna. Com y múltiplo de 8 cada coluna é um único
+// byte; caso contrário a coluna é deslocada e dividida entre duas páginas. A célula 8x8 é opaca,
+// como no desenho pixel a pixel
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
-  if (c >= 'A' && c <= 'Z') {
-    // Uppercase letters (A-Z start at index 88)
-    index = (c - 'A' + 11) * 8;
-  } else if (c >= '0' && c <= '9') {
-    // Numbers 0-9 (start at index 8)
-    index = (c - '0' + 1) * 8;
-  } else if (c >= 'a' && c <= 'z') {
-    // Lowercase letters (a-z start at index 296)
-    index = (c - 'a' + 37) * 8;
-  } else {
+  uint8_t columns[ASSET_GLYPH_WIDTH];
+  if (x >= ssd->width || y >= ssd->height || !asset_glyph_decode(c, columns)) {
     // Unsupported character (draw nothing)
     return;
   }
 
-  // Render the character pixel-by-pixel
-  for (uint8_t i = 0; i < 8; ++i) {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j) {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
-    }
+  uint8_t count = (ssd->width - x < 8) ? ssd->width - x : 8;
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  uint8_t *dst = &ssd->ram_buffer[(x << 3) + page + 1];
+
+  ssd1306_mark_dirty(ssd, x, x + count - 1, y, y + 7);
+
+  if (shift == 0) {
+    for (uint8_t i = 0; i < count; ++i, dst += 8)
+      *dst = columns[i];
+    return;
+  }
+
+  bool has_lower_page = page + 1 < ssd->pages;
+  uint8_t upper_mask = 0xFF << shift;
+  uint8_t lower_mask = 0xFF >> (8 - shift);
+  for (uint8_t i = 0; i < count; ++i, dst += 8) {
+    uint16_t bits = columns[i] << shift;
+    dst[0] = (dst[0] & ~upper_mask) | (uint8_t)bits;
+    if (has_lower_page)
+      dst[1] = (dst[1] & ~lower_mask) | (uint8_t)(bits >> 8);
   }
 }
 
@@ -184,3 +631,119 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
     }
   }
 }
+
+// modo interno do ssd1306_blit_span: só conta os pixels opacos sobre pixels acesos
+#define SSD1306_BLIT_TEST 0xFF
+
+// bits válidos da página `page` de um bitmap de altura `height` (a última pode estar incompleta)
+static inline uint8_t ssd1306_bitmap_rows(uint8_t height, uint8_t page) {
+  uint8_t rows = height - (page << 3);
+  return rows >= 8 ? 0xFF : (uint8_t)((1u << rows) - 1);
+}
+
+// Percorre as colunas visíveis do bitmap em (x, y) e aplica o modo a cada byte de página do destino.
+// Cada byte do bitmap é deslocado por y & 7 e dividido entre duas páginas; as páginas e colunas
+// fora da tela são puladas, então coordenadas negativas ou além da borda só recortam o desenho
+static uint16_t ssd1306_blit_span(ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y, uint8_t mode) {
+  int x0 = x < 0 ? 0 : x;
+  int x1 = x + bitmap->width > ssd->width ? ssd->width : x + bitmap->width;
+  int y0 = y < 0 ? 0 : y;
+  int y1 = y + bitmap->height > ssd->height ? ssd->height : y + bitmap->height;
+  if (x0 >= x1 || y0 >= y1)
+    return 0;
+
+  // divisão arredondada para baixo também com y negativo
+  int first_page = y >> 3;
+  uint8_t shift = y & 7;
+  uint8_t src_pages = (bitmap->height + 7) >> 3;
+  uint16_t hits = 0;
+
+  if (mode != SSD1306_BLIT_TEST)
+    ssd1306_mark_dirty(ssd, x0, x1 - 1, y0, y1 - 1);
+
+  for (int dx = x0; dx < x1; ++dx) {
+    uint8_t *column = &ssd->ram_buffer[(dx << 3) + 1];
+    uint8_t sx = dx - x;
+
+    for (uint8_t page = 0; page < src_pages; ++page) {
+      uint8_t rows = ssd1306_bitmap_rows(bitmap->height, page);
+      uint8_t src = bitmap->data[page * bitmap->width + sx] & rows;
+      uint8_t opaque = bitmap->mask ? bitmap->mask[page * bitmap->width + sx] & rows : rows;
+      if (mode == SSD1306_BLIT_TEST && !bitmap->mask)
+        opaque = src;
+
+      uint16_t src_bits = src << shift;
+      uint16_t mask_bits = opaque << shift;
+      for (uint8_t half = 0; half < 2; ++half, src_bits >>= 8, mask_bits >>= 8) {
+        int dst_page = first_page + page + half;
+        uint8_t m = mask_bits;
+        if (m == 0 || dst_page < 0 || dst_page >= ssd->pages)
+          continue;
+
+        uint8_t *dst = &column[dst_page];
+        uint8_t bits = src_bits;
+        switch (mode) {
+          case SSD1306_BLIT_OR:
+            *dst |= bits & m;
+            break;
+          case SSD1306_BLIT_XOR:
+            *dst ^= bits & m;
+            break;
+          case SSD1306_BLIT_REPLACE:
+            *dst = (*dst & ~m) | (bits & m);
+            break;
+          default:
+            hits += __builtin_popcount(*dst & m);
+            break;
+        }
+      }
+    }
+  }
+  return hits;
+}
+
+// desenha o bitmap com o canto superior esquerdo em (x, y), recortado nas bordas do display
+void ssd1306_blit(ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y, ssd1306_blit_mode_t mode) {
+  ssd1306_blit_span(ssd, bitmap, x, y, mode);
+}
+
+// conta os pixels opacos do bitmap em (x, y) que cairiam sobre pixels acesos do destino de desenho
+// atual (o fundo ou a camada selecionada), sem desenhar. 0 indica que não há colisão
+uint16_t ssd1306_blit_test(ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y) {
+  return ssd1306_blit_span(ssd, bitmap, x, y, SSD1306_BLIT_TEST);
+}
+
+// 8 linhas opacas do bitmap na coluna sx a partir da linha sy (que pode ser negativa ou passar da
+// altura; as linhas fora do bitmap são transparentes)
+static uint8_t ssd1306_bitmap_opaque(const ssd1306_bitmap_t *bitmap, uint8_t sx, int sy) {
+  const uint8_t *bits = bitmap->mask ? bitmap->mask : bitmap->data;
+  uint16_t column = 0;
+  int page = sy >> 3;
+  for (uint8_t half = 0; half < 2; ++half, ++page) {
+    if (page < 0 || page >= (bitmap->height + 7) >> 3)
+      continue;
+    uint8_t byte = bits[page * bitmap->width + sx] & ssd1306_bitmap_rows(bitmap->height, page);
+    column |= byte << (half << 3);
+  }
+  return column >> (sy & 7);
+}
+
+// colisão exata entre dois bitmaps posicionados, sem passar pelo framebuffer: primeiro a
+// interseção dos retângulos, depois 8 linhas por vez em cada coluna comum
+bool ssd1306_bitmaps_collide(const ssd1306_bitmap_t *a, int ax, int ay, const ssd1306_bitmap_t *b, int bx, int by) {
+  int x0 = ax > bx ? ax : bx;
+  int x1 = ax + a->width < bx + b->width ? ax + a->width : bx + b->width;
+  int y0 = ay > by ? ay : by;
+  int y1 = ay + a->height < by + b->height ? ay + a->height : by + b->height;
+  if (x0 >= x1 || y0 >= y1)
+    return false;
+
+  for (int x = x0; x < x1; ++x) {
+    for (int y = y0; y < y1; y += 8) {
+      uint8_t rows = y1 - y >= 8 ? 0xFF : (uint8_t)((1u << (y1 - y)) - 1);
+      if (ssd1306_bitmap_opaque(a, x - ax, y - ay) & ssd1306_bitmap_opaque(b, x - bx, y - by) & rows)
+        return true;
+    }
+  }
+  return false;
+}
@@ -1,9 +1,19 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MAX_PAGES 8
+#define SSD1306_MAX_COMMANDS 32
+// quadro completo mais, por janela, os 7 bytes de comando e o byte de controle dos dados, e a
+// transação da linha inicial
+#define SSD1306_FRONT_WORDS(bufsize) ((bufsize) + SSD1306_MAX_PAGES * 8 + 2)
+#define SSD1306_MAX_LAYERS 4
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -25,19 +35,88 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
+// como uma camada se combina com o que está abaixo dela: OR acende os pixels da camada, AND_NOT apaga
+typedef enum {
+  SSD1306_BLEND_OR,
+  SSD1306_BLEND_AND_NOT
+} ssd1306_blend_t;
+
+// camada sobreposta ao fundo, com o mesmo layout do ram_buffer (byte 0 sem uso)
+typedef struct {
+  uint8_t *buffer;
+  ssd1306_blend_t blend;
+  bool visible;
+} ssd1306_layer_t;
+
+// Bitmap de 1 bit por pixel no mesmo formato de página do display: linhas de páginas de 8 pixels,
+// cada uma com `width` bytes, bit 0 = linha de cima (data[page * width + x]). A máscara, opcional,
+// tem o mesmo formato e marca os pixels opacos; sem máscara, os pixels acesos do bitmap são os opacos
+typedef struct {
+  uint8_t width, height;
+  const uint8_t *data;
+  const uint8_t *mask;
+} ssd1306_bitmap_t;
+
+typedef enum {
+  SSD1306_BLIT_OR, // acende os pixels acesos do bitmap
+  SSD1306_BLIT_XOR, // inverte os pixels acesos do bitmap; repetir no mesmo lugar desfaz
+  SSD1306_BLIT_REPLACE // copia o bitmap onde ele é opaco (a máscara, ou o retângulo todo sem ela)
+} ssd1306_blit_mode_t;
+
+// Contadores de tráfego no barramento (inclui o byte de endereço de cada transação)
+typedef struct {
+  uint32_t frames;
+  uint32_t frame_bytes; // bytes enviados no último ssd1306_send_data
+  uint32_t frame_transactions; // transações I2C (start ... stop) do último envio
+  uint32_t total_bytes;
+  uint32_t total_transactions;
+} ssd1306_stats_t;
+
 typedef struct {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  uint8_t *ram_buffer; // destino das funções de desenho: o fundo ou uma camada
   size_t bufsize;
+  // Composição: o fundo é retido entre quadros e as camadas são combinadas sobre ele, byte a byte,
+  // apenas nas colunas sujas, no momento do envio. Sem camadas o frame_buffer é o próprio fundo
+  uint8_t *background_buffer;
+  uint8_t *frame_buffer; // imagem composta, a que vai para o display
+  ssd1306_layer_t *layers[SSD1306_MAX_LAYERS];
+  uint8_t layer_count;
   uint8_t port_buffer[2];
+  // faixa de colunas alterada em cada página desde o último envio (x0 > x1 indica página limpa)
+  uint8_t dirty_x0[SSD1306_MAX_PAGES];
+  uint8_t dirty_x1[SSD1306_MAX_PAGES];
+  bool force_refresh;
+  // linha da GDDRAM mostrada no topo da tela; enviada junto do próximo quadro, depois dos dados
+  uint8_t start_line;
+  bool start_line_pending;
+  uint8_t *window_buffer;
+  uint8_t *sent_buffer; // cópia do que já está na RAM do controlador
+  // front buffer do envio assíncrono: janelas já codificadas como palavras do IC_DATA_CMD
+  uint16_t *front_buffer;
+  size_t front_len;
+  int dma_channel;
+  volatile bool flush_pending;
+  ssd1306_stats_t stats;
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
+void ssd1306_power(ssd1306_t *ssd, bool on);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t len);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_data_async(ssd1306_t *ssd);
+bool ssd1306_flush_busy(ssd1306_t *ssd);
+void ssd1306_flush_wait(ssd1306_t *ssd);
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1);
+void ssd1306_mark_all_dirty(ssd1306_t *ssd);
+void ssd1306_set_start_line(ssd1306_t *ssd, uint8_t line);
+bool ssd1306_layer_add(ssd1306_t *ssd, ssd1306_layer_t *layer, ssd1306_blend_t blend);
+void ssd1306_layer_select(ssd1306_t *ssd, ssd1306_layer_t *layer);
+void ssd1306_layer_set_visible(ssd1306_t *ssd, ssd1306_layer_t *layer, bool visible);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -47,3 +126,8 @@ void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+void ssd1306_blit(ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y, ssd1306_blit_mode_t mode);
+uint16_t ssd1306_blit_test(ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y);
+bool ssd1306_bitmaps_collide(const ssd1306_bitmap_t *a, int ax, int ay, const ssd1306_bitmap_t *b, int bx, int by);
+
+#endif
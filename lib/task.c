@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include "hardware/sync.h"
+#include "task.h"
+
+// laço de um núcleo; não retorna
+void task_run(task_t *const tasks[], uint count) {
+  while (true) {
+    bool progress = false;
+    uint64_t wake_us = UINT64_MAX;
+
+    for (uint i = 0; i < count; ++i) {
+      task_t *task = tasks[i];
+      if (task->state == TASK_DONE)
+        continue;
+
+      uint32_t steps = task->steps;
+      uint64_t start_us = time_us_64();
+      task->state = task->run(task);
+
+      uint32_t run_us = time_us_64() - start_us;
+      if (run_us > task->run_max_us)
+        task->run_max_us = run_us;
+      if (task->state != TASK_WAITING || task->steps != steps)
+        progress = true;
+      if (task->state == TASK_WAITING && task->wake_us && task->wake_us < wake_us)
+        wake_us = task->wake_us;
+    }
+
+    // uma tarefa que avançou pode ter liberado outra: só dorme depois de uma rodada sem avanço
+    if (progress)
+      continue;
+    if (wake_us != UINT64_MAX)
+      best_effort_wfe_or_timeout(from_us_since_boot(wake_us));
+    else
+      __wfe();
+  }
+}
+
+// avanços e maior trecho numa rodada de cada tarefa desde o boot
+void task_report(const char *core, task_t *const tasks[], uint count) {
+  printf("Tarefas (%s):", core);
+  for (uint i = 0; i < count; ++i)
+    printf("%s %s %u avancos, max %u us", i ? " |" : "", tasks[i]->name, (uint)tasks[i]->steps, (uint)tasks[i]->run_max_us);
+  printf("\n");
+}
@@ -0,0 +1,85 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "pico/stdlib.h"
+
+// Tarefas cooperativas sem pilha própria, no estilo protothread. Cada tarefa é uma função que volta
+// ao ponto em que parou: TASK_BEGIN abre um switch sobre a linha de retomada e as esperas gravam
+// __LINE__ antes de devolver o controle. Variáveis locais não sobrevivem a uma espera; o estado que
+// atravessa esperas fica em globais, estáticas ou em task->arg. Também não se espera dentro de um
+// switch da própria tarefa.
+//
+// task_run executa as tarefas de um núcleo em rodadas. Uma tarefa esperando um DMA, um alarme ou
+// uma fila só reavalia a condição; quando nenhuma avançou numa rodada o núcleo dorme em WFE até o
+// menor wake_us pedido, e qualquer interrupção (fim de DMA, alarme, borda de GPIO) ou __sev do
+// outro núcleo antecipa a rodada seguinte. Assim as transferências de ADC, I2C e PIO de estágios
+// diferentes ficam em andamento ao mesmo tempo, sem que um estágio bloqueie os outros.
+
+typedef enum {
+  TASK_WAITING, // parada numa condição falsa ou numa pausa
+  TASK_YIELDED, // cedeu a vez mas pode continuar na próxima rodada
+  TASK_DONE,
+} task_state_t;
+
+typedef struct task task_t;
+typedef task_state_t (*task_fn_t)(task_t *task);
+
+struct task {
+  const char *name;
+  task_fn_t run;
+  void *arg;
+  uint16_t line; // ponto de retomada; 0 é o início
+  uint64_t wake_us; // prazo para ser reavaliada mesmo sem interrupção; 0 sem prazo
+  task_state_t state;
+
+  // estatísticas, escritas só pelo núcleo da tarefa
+  volatile uint32_t steps; // esperas vencidas: cada uma é um avanço da tarefa
+  volatile uint32_t run_max_us; // maior trecho executado numa rodada
+};
+
+#define TASK_INIT(task_name, fn, task_arg) { .name = (task_name), .run = (fn), .arg = (task_arg) }
+
+#define TASK_BEGIN(task) switch ((task)->line) { case 0: (task)->steps++;
+
+#define TASK_END(task) } (task)->line = 0; return TASK_DONE;
+
+// espera a condição, reavaliada a cada rodada. A primeira avaliação entra direto no case
+#define TASK_WAIT_UNTIL(task, condition) \
+  do { \
+    (task)->line = __LINE__; \
+    __attribute__((fallthrough)); \
+    case __LINE__: \
+    if (!(condition)) \
+      return TASK_WAITING; \
+    (task)->steps++; \
+  } while (0)
+
+// espera até o instante (us desde o boot); o núcleo pode dormir até lá
+#define TASK_SLEEP_UNTIL(task, time_us) \
+  do { \
+    (task)->wake_us = (time_us); \
+    TASK_WAIT_UNTIL(task, time_us_64() >= (task)->wake_us); \
+    (task)->wake_us = 0; \
+  } while (0)
+
+// devolve o controle sem ter avançado: retoma na próxima rodada, que pode esperar pelo wake_us
+#define TASK_PAUSE(task) \
+  do { \
+    (task)->line = __LINE__; \
+    return TASK_WAITING; \
+    case __LINE__:; \
+  } while (0)
+
+// cede a vez às outras tarefas, contando como avanço
+#define TASK_YIELD(task) \
+  do { \
+    (task)->line = __LINE__; \
+    return TASK_YIELDED; \
+    case __LINE__:; \
+    (task)->steps++; \
+  } while (0)
+
+void task_run(task_t *const tasks[], uint count);
+void task_report(const char *core, task_t *const tasks[], uint count);
+
+#endif
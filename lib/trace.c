@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include "hardware/clocks.h"
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+trace_stage_stats_t trace_stats[TRACE_MAX_STAGES];
+
+static const char *const *trace_names;
+static uint trace_stage_count;
+
+// um buffer circular por núcleo: cada um tem um único escritor
+static trace_event_t trace_ring[2][TRACE_RING_SIZE];
+static volatile uint32_t trace_ring_head[2];
+
+void trace_init(const char *const names[], uint count) {
+  trace_names = names;
+  trace_stage_count = count < TRACE_MAX_STAGES ? count : TRACE_MAX_STAGES;
+  for (uint i = 0; i < TRACE_MAX_STAGES; ++i)
+    trace_stats[i] = (trace_stage_stats_t){ .min_cycles = UINT32_MAX };
+}
+
+// o SysTick é de cada núcleo: precisa ser chamada uma vez no core0 e uma vez no core1
+void trace_core_init(void) {
+  systick_hw->csr = 0;
+  systick_hw->rvr = TRACE_CYCLES_MASK;
+  systick_hw->cvr = 0;
+  systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+static inline uint trace_bucket(uint32_t cycles) {
+  if (cycles < 4)
+    return cycles;
+  uint exponent = 31 - __builtin_clz(cycles);
+  return 4 * (exponent - 1) + ((cycles >> (exponent - 2)) & 3);
+}
+
+// maior valor que cai na faixa
+static uint32_t trace_bucket_limit(uint bucket) {
+  if (bucket < 4)
+    return bucket;
+  uint exponent = bucket / 4 + 1;
+  return ((4 + bucket % 4 + 1) << (exponent - 2)) - 1;
+}
+
+void trace_record(uint stage, uint32_t start) {
+  uint32_t cycles = (start - trace_now()) & TRACE_CYCLES_MASK;
+  trace_stage_stats_t *stats = &trace_stats[stage];
+
+  stats->count++;
+  stats->sum_cycles += cycles;
+  if (cycles < stats->min_cycles)
+    stats->min_cycles = cycles;
+  if (cycles > stats->max_cycles)
+    stats->max_cycles = cycles;
+  stats->buckets[trace_bucket(cycles)]++;
+
+  uint core = get_core_num();
+  uint32_t head = trace_ring_head[core];
+  trace_ring[core][head & (TRACE_RING_SIZE - 1)] = (trace_event_t){
+    .end_us = time_us_32(),
+    .cycles = cycles,
+    .stage = stage,
+  };
+  trace_ring_head[core] = head + 1;
+}
+
+// limite superior da faixa onde a contagem acumulada atinge o percentual, limitado ao máximo visto
+uint32_t trace_percentile(uint stage, uint percent) {
+  const trace_stage_stats_t *stats = &trace_stats[stage];
+  if (stats->count == 0)
+    return 0;
+
+  uint64_t target = ((uint64_t)stats->count * percent + 99) / 100;
+  uint64_t seen = 0;
+  for (uint bucket = 0; bucket < TRACE_BUCKETS; ++bucket) {
+    seen += stats->buckets[bucket];
+    if (seen >= target) {
+      uint32_t limit = trace_bucket_limit(bucket);
+      return limit < stats->max_cycles ? limit : stats->max_cycles;
+    }
+  }
+  return stats->max_cycles;
+}
+
+// imprime mínimo, média, p99 e máximo de cada estágio em us
+void trace_report(void) {
+  uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+
+  for (uint stage = 0; stage < trace_stage_count; ++stage) {
+    const trace_stage_stats_t *stats = &trace_stats[stage];
+    if (stats->count == 0)
+      continue;
+
+    printf("Trace %-16s n=%-7u min %u.%02u | media %u.%02u | p99 %u.%02u | max %u.%02u us\n",
+      trace_names[stage],
+      (uint)stats->count,
+      (uint)(stats->min_cycles / cycles_per_us), (uint)(stats->min_cycles % cycles_per_us * 100 / cycles_per_us),
+      (uint)(stats->sum_cycles / stats->count / cycles_per_us), (uint)(stats->sum_cycles / stats->count % cycles_per_us * 100 / cycles_per_us),
+      (uint)(trace_percentile(stage, 99) / cycles_per_us), (uint)(trace_percentile(stage, 99) % cycles_per_us * 100 / cycles_per_us),
+      (uint)(stats->max_cycles / cycles_per_us), (uint)(stats->max_cycles % cycles_per_us * 100 / cycles_per_us));
+  }
+}
+
+static uint32_t trace_checksum;
+
+static void trace_put(const void *data, uint len) {
+  const uint8_t *bytes = data;
+  for (uint i = 0; i < len; ++i) {
+    trace_checksum += bytes[i];
+    putchar_raw(bytes[i]);
+  }
+}
+
+// os campos são enviados um a um; o RP2040 é little-endian
+void trace_dump(void) {
+  trace_checksum = 0;
+
+  uint8_t stages = trace_stage_count;
+  uint8_t buckets = TRACE_BUCKETS;
+  uint16_t ring_size = TRACE_RING_SIZE;
+  uint32_t clk_hz = clock_get_hz(clk_sys);
+  trace_put("TRC1", 4);
+  trace_put(&stages, 1);
+  trace_put(&buckets, 1);
+  trace_put(&ring_size, 2);
+  trace_put(&clk_hz, 4);
+
+  for (uint stage = 0; stage < trace_stage_count; ++stage) {
+    const trace_stage_stats_t *stats = &trace_stats[stage];
+    uint8_t name_len = 0;
+    while (trace_names[stage][name_len] && name_len < 255)
+      name_len++;
+    trace_put(&name_len, 1);
+    trace_put(trace_names[stage], name_len);
+    trace_put(&stats->count, 4);
+    trace_put(&stats->min_cycles, 4);
+    trace_put(&stats->max_cycles, 4);
+    trace_put(&stats->sum_cycles, 8);
+    trace_put(stats->buckets, sizeof(stats->buckets));
+  }
+
+  for (uint core = 0; core < 2; ++core) {
+    uint32_t head = trace_ring_head[core];
+    trace_put(&head, 4);
+    for (uint i = 0; i < TRACE_RING_SIZE; ++i) {
+      const trace_event_t *event = &trace_ring[core][i];
+      trace_put(&event->end_us, 4);
+      trace_put(&event->cycles, 4);
+      trace_put(&event->stage, 1);
+    }
+  }
+
+  uint32_t checksum = trace_checksum;
+  trace_put(&checksum, 4);
+  stdio_flush();
+}
+
+#else
+
+void trace_init(const char *const names[], uint count) { (void)names; (void)count; }
+void trace_core_init(void) {}
+void trace_report(void) {}
+void trace_dump(void) {}
+
+#endif
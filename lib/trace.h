@@ -0,0 +1,70 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+
+// Pontos de rastreamento do caminho quente. Cada estágio é delimitado por TRACE_BEGIN/TRACE_END,
+// que leem o SysTick do núcleo (contador de ciclos de 24 bits do clk_sys, um por núcleo) e
+// registram a duração em ciclos:
+//  - num histograma log-linear por estágio (mínimo, média, máximo e p99 desde o boot);
+//  - num buffer circular por núcleo com os últimos eventos (instante do fim em us + ciclos).
+// Com TRACE_ENABLED 0 as macros somem e nada é compilado. Cada estágio deve ser medido sempre no
+// mesmo núcleo, assim cada contador tem um único escritor e não há trava.
+//
+// trace_dump envia tudo em binário pela stdio (sem tradução de \n), little-endian:
+//   "TRC1" u8 estágios, u8 faixas, u16 eventos por núcleo, u32 clk_sys em Hz
+//   por estágio: u8 tamanho do nome, nome, u32 contagem, u32 mínimo, u32 máximo, u64 soma,
+//                u32 contagem de cada faixa
+//   por núcleo: u32 total de eventos gravados e os eventos (u32 fim em us, u32 ciclos, u8 estágio)
+//   u32 soma de todos os bytes anteriores
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+#define TRACE_MAX_STAGES 12
+#define TRACE_RING_BITS 7 // 128 eventos por núcleo
+#define TRACE_RING_SIZE (1u << TRACE_RING_BITS)
+// faixas do histograma: valores < 4 têm faixa própria; acima disso, 4 faixas por potência de 2
+// até 2^24 ciclos (erro de até 25% no p99)
+#define TRACE_BUCKETS 92
+#define TRACE_CYCLES_MASK 0xFFFFFFu
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_cycles, max_cycles;
+  uint64_t sum_cycles;
+  uint32_t buckets[TRACE_BUCKETS];
+} trace_stage_stats_t;
+
+typedef struct {
+  uint32_t end_us;
+  uint32_t cycles;
+  uint8_t stage;
+} trace_event_t;
+
+void trace_init(const char *const names[], uint count);
+void trace_core_init(void);
+void trace_record(uint stage, uint32_t start);
+uint32_t trace_percentile(uint stage, uint percent);
+void trace_report(void);
+void trace_dump(void);
+
+extern trace_stage_stats_t trace_stats[TRACE_MAX_STAGES];
+
+#if TRACE_ENABLED
+#include "hardware/structs/systick.h"
+
+// o SysTick conta para baixo
+static inline uint32_t trace_now(void) {
+  return systick_hw->cvr;
+}
+
+#define TRACE_BEGIN(stage) uint32_t trace_start_##stage = trace_now()
+#define TRACE_END(stage) trace_record((stage), trace_start_##stage)
+#else
+#define TRACE_BEGIN(stage) do {} while (0)
+#define TRACE_END(stage) do {} while (0)
+#endif
+
+#endif
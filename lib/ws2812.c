@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/dma.h"
+#include "ws2812.h"
+#include "ws2812_parallel.pio.h"
+
+// posição de um elemento (x, y) na ordem da cadeia de uma grade
+static uint ws2812_grid_index(const ws2812_grid_t *grid, uint x, uint y) {
+  if (grid->flip_x)
+    x = grid->columns - 1 - x;
+  if (grid->flip_y)
+    y = grid->rows - 1 - y;
+
+  uint major = grid->column_major ? x : y;
+  uint minor = grid->column_major ? y : x;
+  uint count = grid->column_major ? grid->rows : grid->columns;
+  if (grid->serpentine && (major & 1))
+    minor = count - 1 - minor;
+  return major * count + minor;
+}
+
+// monta a tabela pixel -> posição no buffer do fio. Os painéis são distribuídos em blocos
+// consecutivos da cadeia, o mesmo número por fita (a última pode ficar mais curta)
+static void ws2812_build_map(ws2812_t *leds, uint tiles_per_strip) {
+  const ws2812_grid_t *tile = &leds->config.tile;
+  uint tile_leds = tile->columns * tile->rows;
+
+  for (uint y = 0; y < leds->height; ++y) {
+    for (uint x = 0; x < leds->width; ++x) {
+      uint chain_tile = ws2812_grid_index(&leds->config.tiles, x / tile->columns, y / tile->rows);
+      uint led = ws2812_grid_index(tile, x % tile->columns, y % tile->rows);
+      uint strip = chain_tile / tiles_per_strip;
+      uint position = (chain_tile % tiles_per_strip) * tile_leds + led;
+      leds->map[y * leds->width + x] = strip * leds->strip_leds + position;
+    }
+  }
+}
+
+// carrega o programa com o "out x" ajustado para a largura dos planos e reserva uma máquina de estados
+static bool ws2812_claim_pio(ws2812_t *leds, uint *offset) {
+  uint16_t instructions[sizeof(ws2812_parallel_program_instructions) / sizeof(uint16_t)];
+  memcpy(instructions, ws2812_parallel_program_instructions, sizeof(instructions));
+  instructions[0] = pio_encode_out(pio_x, leds->lane_bits);
+  pio_program_t program = ws2812_parallel_program;
+  program.instructions = instructions;
+
+  const PIO candidates[] = { pio0, pio1 };
+  for (uint i = 0; i < 2; ++i) {
+    PIO pio = candidates[i];
+    if (!pio_can_add_program(pio, &program))
+      continue;
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0)
+      continue;
+    leds->pio = pio;
+    leds->sm = sm;
+    *offset = pio_add_program(pio, &program);
+    return true;
+  }
+  return false;
+}
+
+bool ws2812_init(ws2812_t *leds, const ws2812_config_t *config) {
+  const ws2812_grid_t *tile = &config->tile;
+  const ws2812_grid_t *tiles = &config->tiles;
+  uint tile_count = tiles->columns * tiles->rows;
+  if (config->strips == 0 || config->strips > WS2812_MAX_STRIPS || config->strips > tile_count)
+    return false;
+
+  *leds = (ws2812_t){ .config = *config, .dma_channel = -1 };
+  leds->width = tile->columns * tiles->columns;
+  leds->height = tile->rows * tiles->rows;
+  uint tiles_per_strip = (tile_count + config->strips - 1) / config->strips;
+  leds->strip_leds = tiles_per_strip * tile->columns * tile->rows;
+  leds->lane_bits = 1;
+  while (leds->lane_bits < config->strips)
+    leds->lane_bits <<= 1;
+
+  leds->map = calloc(leds->width * leds->height, sizeof(uint16_t));
+  leds->wire = calloc(config->strips * leds->strip_leds, sizeof(uint32_t));
+  ws2812_build_map(leds, tiles_per_strip);
+
+  // com uma fita cada palavra do buffer do fio já é um LED (24 bits); com mais, planos de 32 bits
+  uint bits = leds->strip_leds * 24;
+  uint pull_threshold = 24;
+  uint words = leds->strip_leds;
+  const uint32_t *source = leds->wire;
+  if (config->strips > 1) {
+    leds->plane_words = (bits * leds->lane_bits + 31) / 32;
+    leds->planes = calloc(leds->plane_words, sizeof(uint32_t));
+    // os planos que completam a última palavra saem como bits 0 depois do fim das fitas
+    bits = leds->plane_words * 32 / leds->lane_bits;
+    pull_threshold = 32;
+    words = leds->plane_words;
+    source = leds->planes;
+  }
+  leds->frame_us = (uint64_t)bits * 1000000 / WS2812_FREQ;
+
+  uint offset;
+  if (!ws2812_claim_pio(leds, &offset))
+    return false;
+  ws2812_parallel_program_init(leds->pio, leds->sm, offset, config->base_pin, config->strips, pull_threshold, WS2812_FREQ);
+
+  // DMA alimenta a FIFO da PIO no ritmo do DREQ da máquina de estados
+  leds->dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config dma_config = dma_channel_get_default_config(leds->dma_channel);
+  channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_32);
+  channel_config_set_read_increment(&dma_config, true);
+  channel_config_set_write_increment(&dma_config, false);
+  channel_config_set_dreq(&dma_config, pio_get_dreq(leds->pio, leds->sm, true));
+  dma_channel_configure(leds->dma_channel, &dma_config, &leds->pio->txf[leds->sm], source, words, false);
+  return true;
+}
+
+// palavras do buffer do fio, contando as posições sem LED no fim das fitas mais curtas
+uint ws2812_led_count(const ws2812_t *leds) {
+  return leds->config.strips * leds->strip_leds;
+}
+
+uint ws2812_index(const ws2812_t *leds, uint x, uint y) {
+  return leds->map[y * leds->width + x];
+}
+
+// escreve um pixel no buffer do fio; só é enviado em ws2812_end_frame
+void ws2812_set_pixel(ws2812_t *leds, uint x, uint y, uint32_t grb) {
+  if (x < leds->width && y < leds->height)
+    leds->wire[leds->map[y * leds->width + x]] = grb;
+}
+
+// Indica se o último quadro já saiu pelo fio e o tempo de reset já passou.
+bool ws2812_ready(const ws2812_t *leds) {
+  return !dma_channel_is_busy(leds->dma_channel) && time_us_64() >= leds->ready_at_us;
+}
+
+void ws2812_wait(const ws2812_t *leds) {
+  while (!ws2812_ready(leds))
+    tight_loop_contents();
+}
+
+// transpõe uma matriz 8x8 de bits: o bit j do byte i vai para o bit i do byte j
+static inline uint64_t ws2812_transpose8(uint64_t x) {
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+// gera os planos: para cada posição das fitas e cada byte de cor, os bytes das fitas formam uma
+// matriz 8x8 de bits cuja transposta dá os 8 planos daquele byte, do bit mais significativo ao menor
+static void ws2812_transpose(ws2812_t *leds) {
+  uint strips = leds->config.strips;
+  uint lane_bits = leds->lane_bits;
+  uint32_t *out = leds->planes;
+  uint32_t word = 0;
+  uint fill = 0;
+
+  for (uint i = 0; i < leds->strip_leds; ++i) {
+    for (int shift = 24; shift >= 8; shift -= 8) {
+      uint64_t bytes = 0;
+      for (uint s = 0; s < strips; ++s)
+        bytes |= (uint64_t)((leds->wire[s * leds->strip_leds + i] >> shift) & 0xFF) << (8 * s);
+      uint64_t planes = ws2812_transpose8(bytes);
+
+      for (int bit = 7; bit >= 0; --bit) {
+        fill += lane_bits;
+        word |= (uint32_t)((planes >> (8 * bit)) & 0xFF) << (32 - fill);
+        if (fill == 32) {
+          *out++ = word;
+          word = 0;
+          fill = 0;
+        }
+      }
+    }
+  }
+  if (fill)
+    *out = word;
+}
+
+// Devolve o buffer do fio para ser preenchido. Com uma fita o DMA lê esse buffer, então espera o
+// quadro anterior sair; com várias o envio lê os planos e o buffer pode ser alterado durante ele.
+uint32_t *ws2812_begin_frame(ws2812_t *leds) {
+  if (!leds->planes)
+    ws2812_wait(leds);
+  return leds->wire;
+}
+
+// envia o buffer do fio; retorna logo depois de disparar o DMA
+void ws2812_end_frame(ws2812_t *leds) {
+  ws2812_wait(leds);
+  if (leds->planes)
+    ws2812_transpose(leds);
+
+  leds->ready_at_us = time_us_64() + leds->frame_us + WS2812_RESET_US;
+  if (leds->planes)
+    dma_channel_transfer_from_buffer_now(leds->dma_channel, leds->planes, leds->plane_words);
+  else
+    dma_channel_transfer_from_buffer_now(leds->dma_channel, leds->wire, leds->strip_leds);
+}
@@ -0,0 +1,69 @@
+#ifndef WS2812_H
+#define WS2812_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// Driver de paredes de LEDs WS2812 formadas por painéis iguais. A geometria (LEDs por painel,
+// painéis na parede e a ordem de cada um na cadeia) é configuração; na inicialização o driver monta
+// uma tabela que leva cada pixel (x, y) à posição do LED no buffer do fio, sem cálculo por pixel.
+//
+// Os painéis, na ordem da cadeia, são divididos entre até WS2812_MAX_STRIPS fitas em pinos
+// consecutivos. Uma única máquina de estados da PIO envia todas as fitas ao mesmo tempo: a cada bit
+// de cor ela recebe um plano com o bit daquela posição em cada fita, então o tempo de envio depende
+// da maior fita e não do total de LEDs. Com várias fitas o buffer do fio é transposto em planos antes
+// do envio; com uma fita o DMA lê o buffer do fio direto.
+
+#define WS2812_MAX_STRIPS 8
+#define WS2812_FREQ 800000
+
+// Cada LED recebe 24 bits a 800 kHz (30 us). Depois do último bit a linha precisa ficar em nível
+// baixo pelo tempo de reset para que os LEDs apliquem as cores (280 us cobre o WS2812B mais novo).
+#define WS2812_LED_US 30
+#define WS2812_RESET_US 280
+
+// disposição de uma grade: os LEDs dentro de um painel ou os painéis dentro da parede
+typedef struct {
+  uint8_t columns, rows;
+  bool column_major; // a cadeia percorre colunas em vez de linhas
+  bool serpentine; // linhas (ou colunas) alternadas correm no sentido contrário
+  bool flip_x, flip_y; // o primeiro elemento fica à direita / embaixo
+} ws2812_grid_t;
+
+typedef struct {
+  ws2812_grid_t tile; // LEDs de cada painel
+  ws2812_grid_t tiles; // painéis da parede, na ordem da cadeia
+  uint8_t strips; // fitas em paralelo, a primeira no pino base
+  uint base_pin;
+} ws2812_config_t;
+
+typedef struct {
+  ws2812_config_t config;
+  uint16_t width, height; // em pixels
+  uint16_t strip_leds; // LEDs da maior fita
+  uint8_t lane_bits; // bits de cada plano: fitas arredondadas para potência de 2
+
+  uint16_t *map; // pixel (y * width + x) -> fita * strip_leds + posição na fita
+  // uma palavra GRB por LED, alinhada nos bits 31..8, fita após fita na ordem da cadeia
+  uint32_t *wire;
+  uint32_t *planes; // planos transpostos enviados pelo DMA; NULL com uma fita
+  uint plane_words;
+  uint32_t frame_us; // duração do envio de um quadro, sem o reset
+
+  PIO pio;
+  uint sm;
+  int dma_channel;
+  // instante a partir do qual o último quadro já foi transmitido e travado pelos LEDs
+  uint64_t ready_at_us;
+} ws2812_t;
+
+bool ws2812_init(ws2812_t *leds, const ws2812_config_t *config);
+uint ws2812_led_count(const ws2812_t *leds);
+uint ws2812_index(const ws2812_t *leds, uint x, uint y);
+void ws2812_set_pixel(ws2812_t *leds, uint x, uint y, uint32_t grb);
+bool ws2812_ready(const ws2812_t *leds);
+void ws2812_wait(const ws2812_t *leds);
+uint32_t *ws2812_begin_frame(ws2812_t *leds);
+void ws2812_end_frame(ws2812_t *leds);
+
+#endif
@@ -1,17 +1,29 @@
 #include <stdio.h> // inclui a biblioteca padrão para I/O
 #include <stdlib.h> // utilizar a função abs
+#include <string.h> // comparação dos comandos do console
 #include "pico/stdlib.h" // inclui a biblioteca padrão do pico para gpios e temporizadores
+#include "pico/multicore.h" // inclui a biblioteca para executar código no core1
 #include "hardware/adc.h" // inclui a biblioteca para manipular o hardware adc
 #include "hardware/pwm.h"
 #include "hardware/irq.h" // inclui a biblioteca para interrupções
 #include "hardware/i2c.h" // inclui a biblioteca para utilizar o protocolo i2c
+#include "hardware/sync.h" // inclui __wfe para o core1 esperar sem girar
 #include "lib/ssd1306.h" // inclui a biblioteca com definição das funções para manipulação do display OLED
-#include "lib/font.h" // inclui a biblioteca com as fontes dos caracteres para o display OLED
+#include "lib/scheduler.h" // escalonador de quadros com período fixo
+#include "lib/joystick.h" // captura contínua do joystick por ADC + DMA
+#include "lib/render_queue.h" // fila de retratos do estado entre o core0 e o core1
+#include "lib/input_queue.h" // fila de eventos dos botões gerados na interrupção
+#include "lib/debounce.h" // debounce por botão com alarme de hardware e repetição
+#include "lib/trace.h" // medição do tempo de cada estágio do quadro
+#include "lib/audio.h" // tons e envelopes do buzzer por PWM + DMA
+#include "lib/oled_bus.h" // envios dos displays arbitrados por barramento I2C
+#include "lib/assets.h" // sprites e fonte comprimidos na flash
+#include "lib/led_anim.h" // animação da matriz de LEDs com cross-fade
+#include "lib/power.h" // modo ocioso com clock reduzido e despertar por botão ou joystick
+#include "lib/task.h" // tarefas cooperativas que esperam o hardware sem bloquear o núcleo
+#include "lib/console.h" // console de texto no display com rolagem por hardware
 
-#include "ws2818b.pio.h"
 #include "lib/leds_matrix.h"
-#include "lib/convert_to_rgba.h"
-#include "lib/sprites.h"
 
 #define LED_R 13
 #define LED_G 11
@@ -25,6 +37,7 @@
 #define MATRIX_ROWS 5
 #define MATRIX_COLS 5
 #define MATRIX_LEDS 25 // define o numero de LEDS da matriz
+#define MATRIX_FADE_MS 150 // cross-fade entre sprites da matriz
 
 // Define os valores máximo e mínimo para configuração
 #define VOL_MIN 0
@@ -37,34 +50,142 @@
 #define I2C_SCL 15
 #define SSD_1306_ADDR 0x3C
 
-float buzzer_freq = 0.0;
+// período dos quadros do laço principal e a cada quantos quadros as estatísticas são impressas
+#define FRAME_PERIOD_US 60000
+#define SCHEDULER_REPORT_FRAMES 500
+
+// deslocamento do quadrado, em pixels, que conta como atividade para o modo ocioso
+#define SQUARE_ACTIVITY_PX 2
+
+// caractere recebido pela stdio que pede o envio do trace em binário
+#define TRACE_DUMP_REQUEST 'T'
+// maior linha de comando aceita pela stdio; o excedente é descartado
+#define COMMAND_LINE_MAX 32
+
+// estágios medidos pelo trace. Os do core0 e os do core1 nunca se misturam
+enum {
+    STAGE_CORE0_FRAME,
+    STAGE_INPUT_EVENTS,
+    STAGE_JOYSTICK_READ,
+    STAGE_SQUARE_POSITION,
+    STAGE_CORE1_FRAME,
+    STAGE_MOVE_SQUARE,
+    STAGE_SSD1306_SEND,
+    STAGE_INSERT_SPRITE,
+    STAGE_MATRIX_FADE,
+    STAGE_BUZZER,
+    STAGE_COUNT
+};
+
+const char *const stage_names[STAGE_COUNT] = {
+    [STAGE_CORE0_FRAME] = "core0_frame",
+    [STAGE_INPUT_EVENTS] = "input_events",
+    [STAGE_JOYSTICK_READ] = "joystick_read",
+    [STAGE_SQUARE_POSITION] = "square_position",
+    [STAGE_CORE1_FRAME] = "core1_frame",
+    [STAGE_MOVE_SQUARE] = "move_square",
+    [STAGE_SSD1306_SEND] = "ssd1306_send",
+    [STAGE_INSERT_SPRITE] = "insert_sprite",
+    [STAGE_MATRIX_FADE] = "matrix_fade",
+    [STAGE_BUZZER] = "buzzer",
+};
 
 // inicia a estrutura do display OLED
 ssd1306_t ssd;
-
-// definição de constantes para o display
-volatile uint volume_scale = 0;
-
-const uint16_t central_x_pos = 2049;
-const uint16_t central_y_pos = 1988;
+// a borda fica no fundo do display, desenhada uma única vez; o quadrado fica nesta camada
+ssd1306_layer_t square_layer;
+// quadrado 8x8 do cursor, desenhado com XOR na camada dele: desenhar de novo na mesma posição apaga
+const uint8_t square_pixels[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+const ssd1306_bitmap_t square_bitmap = { .width = 8, .height = 8, .data = square_pixels };
+// os envios ao display passam pelo gerenciador do i2c1, que comporta mais displays no mesmo barramento
+oled_bus_t oled_bus;
+int oled_main;
+
+// comandos recebidos pela stdio (core0) e o console que os mostra no display (core1). O console
+// ocupa a tela inteira enquanto está ativo; o comando "tela" volta ao quadrado
+char command_line[COMMAND_LINE_MAX + 1];
+uint command_line_len = 0;
+bool console_active = false; // (core0)
+console_queue_t console_queue;
+console_t console;
+bool console_shown = false; // (core1)
+char console_text[CONSOLE_COLUMNS + 1]; // (core1)
+
+// definição de constantes para o display. Alterado apenas pelo laço principal do core0
+uint volume_scale = 0;
 
 // define variáveis para debounce do botão
 volatile bool btn_a_state = false;
 volatile bool btn_b_state = false;
-volatile uint32_t last_time_btn_press = 0;
 
-// debounce delay
-const uint32_t debounce_delay_ms = 260;
+// pressões, repetições e solturas já confirmadas pelo debounce de cada botão
+input_queue_t input_queue;
 
 // define qual o LED RGB que estará ligado (vermelho (0) ou verde (1))
-volatile bool led_rgb_state = true;
+bool led_rgb_state = true;
 
 npLED_t leds[LED_COUNT];
-int rgb_matrix[MATRIX_ROWS][MATRIX_COLS][LED_COUNT];
 
-// configurações para o PWM do buzzer
-uint slice_num;
-uint channel_num;
+// paleta dos sprites com o brilho aplicado; refeita apenas quando o global_brightness muda
+uint32_t sprite_palette[ASSET_PALETTE_MAX];
+int sprite_palette_brightness = -1;
+// quadro de destino do fade da matriz; o motor de animação guarda a própria cópia
+uint32_t matrix_target[LED_COUNT];
+
+// divisor do PWM do buzzer para cada volume (200 Hz por nível), calculado em tempo de compilação
+const uint16_t buzzer_tone_div[VOL_MAX + 1] = {
+    AUDIO_DIV_KEEP,
+    AUDIO_DIV(200), AUDIO_DIV(400), AUDIO_DIV(600), AUDIO_DIV(800), AUDIO_DIV(1000),
+    AUDIO_DIV(1200), AUDIO_DIV(1400), AUDIO_DIV(1600), AUDIO_DIV(1800), AUDIO_DIV(2000),
+};
+
+// chirp tocado quando o LED verde acende: sobe até o tom do volume e o sustenta
+audio_step_t buzzer_chirp[3];
+
+scheduler_t scheduler;
+
+// o core0 lê as entradas e publica retratos do estado; o core1 desenha e atualiza as saídas
+render_queue_t render_queue;
+volatile uint32_t render_frames = 0;
+volatile uint32_t render_work_max_us = 0;
+// posição do quadrado no último retrato publicado pelo core0, começando no centro da tela
+int16_t published_square_x = 60;
+int16_t published_square_y = 28;
+
+// ociosidade: o core0 decide quando dormir e acordar; o core1 desliga e religa as saídas dele
+power_t power;
+bool awake = true; // estado pedido nos retratos (core0)
+// posição do quadrado na última atividade; o ruído do ADC fora do centro faz o quadrado oscilar 1 px
+int16_t activity_square_x = 60;
+int16_t activity_square_y = 28;
+volatile bool render_asleep = false; // o core1 já desligou display, matriz e buzzer
+bool outputs_asleep = false; // (core1)
+power_wake_t wake_source; // (core0)
+
+// tarefas cooperativas de cada núcleo, definidas mais abaixo. O estado que atravessa as esperas de
+// uma tarefa fica em globais, como o retrato em renderização
+task_state_t input_task(task_t *task);
+task_state_t frame_task(task_t *task);
+task_state_t power_task(task_t *task);
+task_state_t render_task(task_t *task);
+task_state_t bus_task(task_t *task);
+
+task_t task_input = TASK_INIT("entrada", input_task, NULL);
+task_t task_frame = TASK_INIT("quadros", frame_task, NULL);
+task_t task_power = TASK_INIT("energia", power_task, NULL);
+task_t *const core0_tasks[] = { &task_input, &task_frame, &task_power };
+
+task_t task_render = TASK_INIT("render", render_task, NULL);
+task_t task_bus = TASK_INIT("barramento", bus_task, NULL);
+task_t *const core1_tasks[] = { &task_render, &task_bus };
+render_snapshot_t render_snapshot;
+
+// estado já aplicado às saídas pelo core1; cada estágio só é atualizado quando sua entrada muda
+int square_x = -1;
+int square_y = -1;
+bool outputs_valid = false;
+bool applied_led_rgb_state;
+uint applied_volume_scale;
 
 // inicializa os botões
 void btn_init(uint gpio) {
@@ -73,13 +194,26 @@ void btn_init(uint gpio) {
     gpio_pull_up(gpio);
 }
 
+// o sprite é expandido da flash e a matriz faz o cross-fade até ele; sprite_index < 0 apaga a matriz
 void insert_sprite(int sprite_index) {
-    npLED_t leds[LED_COUNT];
-    int rgb_matrix[MATRIX_ROWS][MATRIX_COLS][3];
+    if (sprite_palette_brightness != global_brightness) {
+        const uint32_t *colors;
+        uint count = asset_sprite_palette(&colors);
+        for (uint i = 0; i < count; ++i) {
+            sprite_palette[i] = npScaleWord(colors[i]);
+        }
+        sprite_palette_brightness = global_brightness;
+    }
 
-    convertARGBtoMatriz(matrix_sprites[sprite_index], rgb_matrix);
-    spriteWrite(rgb_matrix, leds);
-    matrizWrite(leds);
+    if (sprite_index >= 0) {
+        asset_sprite_decode(sprite_index, sprite_palette, matrix_target);
+    } else {
+        memset(matrix_target, 0, sizeof(matrix_target));
+    }
+
+    TRACE_BEGIN(STAGE_MATRIX_FADE);
+    led_anim_show(matrix_target, MATRIX_FADE_MS, LED_ANIM_EASE_IN_OUT);
+    TRACE_END(STAGE_MATRIX_FADE);
 }
 
 // configuração do protocolo i2c
@@ -97,153 +231,523 @@ void i2c_setup() {
     gpio_pull_up(I2C_SCL);
 }
 
+// desenha a borda no fundo. O fundo é retido entre quadros, então isso é feito só na inicialização
+void set_display_border() {
+    ssd1306_layer_select(&ssd, NULL);
+    ssd1306_rect(&ssd, 1, 1, 126, 62, true, false);
+}
+
 void display_init(){
     ssd1306_init(&ssd, WIDTH, HEIGHT, false, SSD_1306_ADDR, I2C_ID); // Inicializa o display
     ssd1306_config(&ssd); // Configura o display
-    ssd1306_send_data(&ssd); // Envia os dados para o display
+    ssd1306_layer_add(&ssd, &square_layer, SSD1306_BLEND_OR);
 
-    // Limpa o display. O display inicia com todos os pixels apagados.
-    ssd1306_fill(&ssd, false);
+    // o fundo começa apagado e recebe a borda; o primeiro envio limpa a RAM do controlador junto
+    set_display_border();
     ssd1306_send_data(&ssd);
-}
 
-// inicialização e configuração do hardware adc
-void adc_setup() {
-    // inicializa o hardware adc
-    adc_init();
+    oled_bus_init(&oled_bus, I2C_ID, I2C_FREQ);
+    oled_main = oled_bus_add(&oled_bus, &ssd, 0);
+}
 
-    // inicialização dos pinos analógicos
-    adc_gpio_init(JOYSTICK_X);
-    adc_gpio_init(JOYSTICK_Y);
+// frequência do buzzer para o estado dado; 0 quando desligado
+float buzzer_frequency(bool state, uint volume) {
+    return (state && volume > 0) ? 200.0f + (volume - 1) * 200.0f : 0.0f;
 }
 
-// realiza a leitura do canal especificado e retorna o valor digital convertido
-uint16_t adc_start_read(uint channel_selected) {
-    uint16_t channel_value = 0;
-
-    if (channel_selected == 0) {
-        // seleciona o canal para o eixo x e realiza a leitura e conversão para o valor digital e armazena em uma variável de 2 bytes
-        adc_select_input(0);
-        // lê o valor do canal 0 para o eixo x [0-4095]
-        channel_value = adc_read();
-    } else if (channel_selected == 1) {
-        // seleciona o canal para o eixo y e realiza a leitura e conversão para o valor digital e armazena em uma variável de 2 bytes
-        adc_select_input(1);
-        // lê o valor do canal 0 para o eixo y [0-4095]
-        channel_value = adc_read();
+// atualiza o buzzer só na transição: o motor de áudio troca o divisor do PWM e o DMA aplica o
+// envelope, sem cálculo em ponto flutuante
+void define_buzzer_state(bool state, uint volume, bool state_changed) {
+    if (state && volume > 0) {
+        uint16_t div = buzzer_tone_div[volume];
+
+        if (state_changed) {
+            buzzer_chirp[0] = (audio_step_t){ .div = div * 3 / 2, .duration_ms = 40, .envelope = &audio_env_pluck };
+            buzzer_chirp[1] = (audio_step_t){ .div = div * 5 / 4, .duration_ms = 40, .envelope = &audio_env_pluck };
+            buzzer_chirp[2] = (audio_step_t){ .div = div, .duration_ms = 0, .envelope = &audio_env_attack };
+            audio_play(buzzer_chirp, 3);
+        } else {
+            audio_tone(div);
+        }
+    } else {
+        // solta a nota e termina em silêncio
+        audio_stop();
     }
+}
 
-    return channel_value;
+// função para tratar as interrupções das gpios. A borda só liga a amostragem do debounce; os
+// eventos confirmados são tratados em process_input_events
+void gpio_irq_handler(uint gpio, uint32_t events) {
+    (void)events;
+    debounce_edge(gpio);
 }
 
-uint16_t adc_convert_value(uint16_t central_pos, uint16_t raw_value) {
-    uint16_t current_differential_pos = abs(central_pos - raw_value);
+// trata os eventos enfileirados pela interrupção no contexto do laço principal (core0)
+void process_input_events() {
+    input_event_t event;
+
+    while (input_queue_pop(&input_queue, &event)) {
+        power_activity(&power);
+
+        // A e B agem na pressão e na repetição (segurar o botão varia o volume); SW só na pressão
+        bool pressed = event.events == INPUT_EVENT_PRESS;
+        if (!pressed && event.events != INPUT_EVENT_REPEAT) {
+            continue;
+        }
+
+        // verifica se o botão A foi pressionado
+        if (event.gpio == BTN_A) {
+            if (led_rgb_state && volume_scale > VOL_MIN) {
+                volume_scale = volume_scale - 1;
+            }
+
+            printf(pressed ? "Botao A pressionado!\n" : "Botao A segurado!\n");
+        } else if (event.gpio == BTN_B) { // verifica se o botão B foi pressionado
+            if (led_rgb_state && volume_scale < VOL_MAX) {
+                volume_scale = volume_scale + 1;
+            }
+
+            printf(pressed ? "Botao B pressionado!\n" : "Botao B segurado!\n");
+        } else if (event.gpio == JOYSTICK_SW && pressed) { // verifica se o botão SW foi pressionado
+            led_rgb_state = !led_rgb_state; // muda o led que estará aceso (vermelho ou verde)
+
+            printf("Botao do joystick (SW) pressionado!\n");
+
+            led_rgb_state ?
+                printf("LED aceso: verde!\n") :
+                printf("LED aceso: vermelho!\n");
+        }
 
-    float conversion_factor = 4095/2047.0;
+        printf("Volume: %d\n", volume_scale);
+        printf("BUZZER: %.2f\n", buzzer_frequency(led_rgb_state, volume_scale));
+    }
+}
 
-    uint16_t value_converted = current_differential_pos * conversion_factor;
+// calcula a posição do quadrado de acordo com as coordenadas fornecidas pelo joystick (core0)
+void square_position(uint16_t x_value, uint16_t y_value, int16_t *x, int16_t *y) {
+    // converte as leituras em coordenadas de tela com o centro calibrado, zona morta e curva de
+    // resposta, em aritmética inteira. O quadrado fica centrado inicialmente em (60, 28)
+    int new_x;
+    int new_y;
+    joystick_map(x_value, y_value, &new_x, &new_y);
 
-    return value_converted;
+    // limita as posições para o tamnho da tela
+    *x = (new_x < 0) ? 0 : (new_x > 120) ? 120 : new_x;
+    *y = (new_y < 0) ? 0 : (new_y > 56) ? 56 : new_y;
 }
 
-void set_display_border() {
-    // limpa o display
-    ssd1306_fill(&ssd, false);
-    ssd1306_send_data(&ssd);
-    ssd1306_rect(&ssd, 1, 1, 126, 62, true, false);
+// redesenha o display apenas se a posição mudou e retorna se houve redesenho (core1)
+bool move_square(int new_x, int new_y) {
+    if (new_x == square_x && new_y == square_y) {
+        return false;
+    }
+
+    // apaga o quadrado anterior apenas na camada dele; a borda no fundo não é redesenhada
+    ssd1306_layer_select(&ssd, &square_layer);
+    if (square_x >= 0) {
+        ssd1306_blit(&ssd, &square_bitmap, square_x, square_y, SSD1306_BLIT_XOR);
+    }
+    square_x = new_x;
+    square_y = new_y;
+
+    // cria o quadrado 8X8; o blit recorta o que passar das bordas
+    ssd1306_blit(&ssd, &square_bitmap, new_x, new_y, SSD1306_BLIT_XOR);
+    return true;
 }
 
-void buzzer_init() {
-    // Configura o pino do buzzer para PWM
-    gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM);
-    slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
-    channel_num = pwm_gpio_to_channel(BUZZER_PIN);
+// aplica o estado dos botões ao LED RGB, à matriz de LEDs e ao buzzer quando ele muda (core1)
+void update_outputs(const render_snapshot_t *snapshot) {
+    bool state = snapshot->led_rgb_state;
+    uint volume = snapshot->volume_scale;
+
+    bool state_changed = !outputs_valid || state != applied_led_rgb_state;
+    bool volume_changed = !outputs_valid || volume != applied_volume_scale;
 
-    // Configuração inicial do PWM
-    pwm_config config = pwm_get_default_config();
-    pwm_init(slice_num, &config, true);
-    pwm_set_enabled(slice_num, false); // desliga PWM do pino ligado ao buzzer
+    // aplica o estado atual para os LED
+    if (state_changed) {
+        gpio_put(LED_G, state);
+        gpio_put(LED_R, !state);
+    }
+
+    if (state_changed || volume_changed) {
+        // atualiza a matriz de LEDs; o fade em si roda no alarme do motor de animação
+        TRACE_BEGIN(STAGE_INSERT_SPRITE);
+        insert_sprite(state ? (int)volume : -1);
+        TRACE_END(STAGE_INSERT_SPRITE);
+
+        TRACE_BEGIN(STAGE_BUZZER);
+        define_buzzer_state(state, volume, outputs_valid && state_changed);
+        TRACE_END(STAGE_BUZZER);
+    }
+
+    outputs_valid = true;
+    applied_led_rgb_state = state;
+    applied_volume_scale = volume;
 }
 
-void define_buzzer_state() {
-    if(led_rgb_state && volume_scale > 0) {
-        buzzer_freq = 200.0f + (volume_scale - 1) * 200.0f;
+// monta o retrato do estado e o entrega ao core1 (core0). Se o core1 ainda não consumiu os
+// anteriores e a fila está cheia o retrato é descartado; o próximo traz o estado completo
+bool publish_snapshot(int16_t x, int16_t y) {
+    render_snapshot_t snapshot = {
+        .frame = scheduler.frames,
+        .square_x = x,
+        .square_y = y,
+        .led_rgb_state = led_rgb_state,
+        .volume_scale = volume_scale,
+        .awake = awake,
+        .console = console_active,
+    };
+    bool pushed = render_queue_push(&render_queue, &snapshot);
+
+    published_square_x = x;
+    published_square_y = y;
+    return pushed;
+}
 
-        // Cálculos para configuração do PWM
-        uint32_t clock = 125000000; // Clock base de 125MHz
-        uint32_t divider = 125000000 / (uint32_t)(buzzer_freq * 1000);
-        uint32_t wrap = 125000000 / (divider * (uint32_t)buzzer_freq) - 1;
+// religa o display; LED RGB, matriz e buzzer são reaplicados por completo no próximo update_outputs
+void outputs_wake() {
+    ssd1306_power(&ssd, true);
+    outputs_valid = false;
+    outputs_asleep = false;
+    render_asleep = false;
+}
 
-        // Aplica as configurações
-        pwm_set_clkdiv_int_frac(slice_num, divider, 0);
-        pwm_set_wrap(slice_num, wrap);
-        pwm_set_chan_level(slice_num, channel_num, wrap / 2); // Define o Duty cycle de 50%
-        pwm_set_enabled(slice_num, true);
+// troca o display entre o quadrado e o console (core1). A linha inicial do console rola a tela
+// inteira, então a borda e a camada do quadrado saem enquanto ele está na tela
+void show_console(bool show) {
+    ssd1306_layer_set_visible(&ssd, &square_layer, !show);
+    ssd1306_layer_select(&ssd, NULL);
+    if (show) {
+        console_init(&console, &ssd);
     } else {
-        // Desliga o PWM
-        pwm_set_enabled(slice_num, false);
-        gpio_put(BUZZER_PIN, 0); // Garante o silêncio
+        console_clear(&console);
+        set_display_border();
     }
+    console_shown = show;
 }
 
-// função para tratar as interrupções das gpios
-void gpio_irq_handler(uint gpio, uint32_t events) {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time()); // retorna o tempo total em ms desde o boot do rp2040
+// escreve no console as linhas recebidas do core0 e devolve se alguma foi escrita (core1). As
+// linhas chegam antes do retrato que liga o console; até lá elas esperam na fila
+bool print_console_lines() {
+    bool printed = false;
+    while (console_shown && console_queue_pop(&console_queue, console_text)) {
+        console_print(&console, console_text);
+        printed = true;
+    }
+    return printed;
+}
 
-    // verifica se a diff entre o tempo atual e a ultima vez que o botão foi pressionado é maior que o tempo de debounce
-    if (current_time - last_time_btn_press > debounce_delay_ms) {
-        last_time_btn_press = current_time;
+// renderiza um retrato (core1). O envio ao display por DMA começa aqui e é acompanhado pela tarefa
+// do barramento; a escrita na matriz fica com o alarme do motor de animação
+void render_frame(const render_snapshot_t *snapshot) {
+    uint64_t start_us = time_us_64();
+    TRACE_BEGIN(STAGE_CORE1_FRAME);
 
-        // verifica se o botão A foi pressionado
-        if (gpio == BTN_A) {
-            if (led_rgb_state && volume_scale > VOL_MIN) {
-                volume_scale = volume_scale - 1;
-            }
+    bool redraw = false;
+    if (snapshot->console != console_shown) {
+        show_console(snapshot->console);
+        redraw = true;
+    }
+    redraw |= print_console_lines();
 
-            printf("Botao A pressionado!\n");
-        } else if (gpio == BTN_B) { // verifica se o botão B foi pressionado
-            if (led_rgb_state && volume_scale < VOL_MAX) {
-                volume_scale = volume_scale + 1;
+    if (!console_shown) {
+        TRACE_BEGIN(STAGE_MOVE_SQUARE);
+        redraw |= move_square(snapshot->square_x, snapshot->square_y);
+        TRACE_END(STAGE_MOVE_SQUARE);
+    }
+
+    if (redraw) {
+        TRACE_BEGIN(STAGE_SSD1306_SEND);
+        oled_bus_request(&oled_bus, oled_main, start_us + FRAME_PERIOD_US);
+        oled_bus_poll(&oled_bus);
+        TRACE_END(STAGE_SSD1306_SEND);
+    }
+
+    // atualiza LED RGB, matriz de LEDs e buzzer se o estado mudou
+    update_outputs(snapshot);
+    power_wake_frame(&power);
+
+    TRACE_END(STAGE_CORE1_FRAME);
+
+    uint32_t work_us = time_us_64() - start_us;
+    if (work_us > render_work_max_us) {
+        render_work_max_us = work_us;
+    }
+    render_frames++;
+}
+
+// tarefa de renderização (core1): espera um retrato novo e o renderiza. No retrato de dormir desliga
+// as saídas: display e charge pump, matriz apagada (uma única escrita) e buzzer em silêncio. Tudo
+// termina antes da confirmação, porque o core0 baixa o clock em seguida e a PIO, o PWM e o I2C
+// mudariam de velocidade no meio de uma transmissão
+task_state_t render_task(task_t *task) {
+    TASK_BEGIN(task);
+    while (true) {
+        TASK_WAIT_UNTIL(task, render_queue_pop_latest(&render_queue, &render_snapshot));
+
+        if (render_snapshot.awake) {
+            if (outputs_asleep) {
+                outputs_wake();
             }
+            render_frame(&render_snapshot);
+            continue;
+        }
+        if (outputs_asleep) {
+            continue;
+        }
 
-            printf("Botao B pressionado!\n");
-        } else if (gpio == JOYSTICK_SW) { // verifica se o botão SW foi pressionado
-            led_rgb_state = !led_rgb_state; // muda o led que estará aceso (vermelho ou verde)
+        TASK_WAIT_UNTIL(task, oled_bus_idle(&oled_bus));
+        ssd1306_power(&ssd, false);
 
-            printf("Botao do joystick (SW) pressionado!\n");
+        memset(matrix_target, 0, sizeof(matrix_target));
+        led_anim_show(matrix_target, 0, LED_ANIM_EASE_LINEAR);
+        TASK_WAIT_UNTIL(task, !led_anim_busy());
+        TASK_SLEEP_UNTIL(task, np_matrix.ready_at_us);
 
-            led_rgb_state ?
-                printf("LED aceso: verde!\n") :
-                printf("LED aceso: vermelho!\n");
+        gpio_put(LED_G, false);
+        gpio_put(LED_R, false);
+        audio_stop();
+        // o envelope de soltura do audio_stop dura 30 ms
+        TASK_SLEEP_UNTIL(task, time_us_64() + 40000);
+
+        outputs_asleep = true;
+        render_asleep = true;
+        __sev();
+    }
+    TASK_END(task);
+}
+
+// tarefa do barramento (core1): inicia os envios pedidos e acompanha o DMA em andamento. O núcleo
+// volta a ela no fim estimado do envio ou antes, em qualquer interrupção
+task_state_t bus_task(task_t *task) {
+    TASK_BEGIN(task);
+    while (true) {
+        task->wake_us = oled_bus_poll(&oled_bus);
+        TASK_PAUSE(task);
+    }
+    TASK_END(task);
+}
+
+// core1: display, matriz de LEDs e buzzer. O envio ao display e à matriz é feito por DMA; o alarme
+// da animação adia o quadro em vez de esperar o reset dos LEDs, e nada disso atrasa a leitura das
+// entradas no core0
+void core1_main() {
+    // o SysTick usado pelo trace é de cada núcleo
+    trace_core_init();
+
+    // configuração do buzzer. O alarme do motor de áudio interrompe o núcleo que o inicia
+    audio_init(BUZZER_PIN);
+
+    // a matriz, apagada pelo core0, passa a ser escrita pelo alarme do motor de animação neste núcleo
+    led_anim_init(LED_COUNT, matrizReady, matrizBeginFrame, matrizEndFrame);
+
+    task_run(core1_tasks, 2);
+}
+
+// tarefa de entrada (core0): botões confirmados entre os quadros são aplicados na hora e publicados
+// com a última posição do quadrado, sem esperar até 60 ms pelo quadro. No modo ocioso os eventos
+// ficam na fila para a tarefa de energia
+task_state_t input_task(task_t *task) {
+    TASK_BEGIN(task);
+    while (true) {
+        TASK_WAIT_UNTIL(task, awake && !input_queue_empty(&input_queue));
+        process_input_events();
+        publish_snapshot(published_square_x, published_square_y);
+    }
+    TASK_END(task);
+}
+
+// executa um comando recebido pela stdio (core0) e mostra a linha e a resposta no console:
+//   vol N   volume de 0 a 10
+//   led     alterna o LED aceso, como o botão SW
+//   tela    sai do console e volta ao quadrado
+void run_command(const char *line) {
+    char reply[CONSOLE_COLUMNS + 1];
+    power_activity(&power);
+
+    if (strcmp(line, "tela") == 0) {
+        console_active = false;
+        printf("Console: tela\n");
+        return;
+    }
+
+    if (strncmp(line, "vol ", 4) == 0) {
+        char *end;
+        long volume = strtol(line + 4, &end, 10);
+        if (end != line + 4 && *end == '\0' && volume >= VOL_MIN && volume <= VOL_MAX) {
+            volume_scale = volume;
+            snprintf(reply, sizeof(reply), "volume %u", volume_scale);
+        } else {
+            snprintf(reply, sizeof(reply), "volume invalido");
         }
+    } else if (strcmp(line, "led") == 0) {
+        led_rgb_state = !led_rgb_state;
+        snprintf(reply, sizeof(reply), led_rgb_state ? "led verde" : "led vermelho");
+#if TRACE_ENABLED
+    } else if (strcmp(line, "joy") == 0) {
+        // ciclos por chamada no RP2040: a conversão em float usa as rotinas de software da ROM
+        uint32_t fixed_cycles;
+        uint32_t float_cycles;
+        joystick_measure(&fixed_cycles, &float_cycles);
+        snprintf(reply, sizeof(reply), "q12 %u fl %u", (uint)fixed_cycles, (uint)float_cycles);
+        printf("Joystick: joystick_map Q12 %u ciclos | float antigo %u ciclos (por par de eixos)\n",
+            (uint)fixed_cycles, (uint)float_cycles);
+#endif
+    } else {
+        snprintf(reply, sizeof(reply), "desconhecido");
+    }
 
-        printf("Volume: %d\n", volume_scale);
-        printf("BUZZER: %.2f\n", buzzer_freq);
+    console_active = true;
+    console_queue_push(&console_queue, line);
+    console_queue_push(&console_queue, reply);
+    printf("Console: %s -> %s\n", line, reply);
+}
+
+// lê sem esperar os caracteres já recebidos pela stdio e devolve true quando completa uma linha em
+// command_line (core0). Um TRACE_DUMP_REQUEST no início da linha envia o trace na hora
+bool read_command_line() {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == TRACE_DUMP_REQUEST && command_line_len == 0) {
+            trace_dump();
+        } else if (c == '\r' || c == '\n') {
+            if (command_line_len > 0) {
+                command_line[command_line_len] = '\0';
+                command_line_len = 0;
+                return true;
+            }
+        } else if (command_line_len < COMMAND_LINE_MAX) {
+            command_line[command_line_len++] = c;
+        }
     }
+    return false;
 }
 
-// calcula a nova posição do quadrado de acordo com as coordenadas fornecidas pelo joystick
-void move_square(uint16_t x_value, uint16_t y_value) {
-    // calcula a distância do centro
-    int16_t x_diff = x_value - central_x_pos;
-    int16_t y_diff = central_y_pos - y_value;
+// imprime as estatísticas de todos os módulos (core0)
+void print_report() {
+    scheduler_report(&scheduler);
+    printf("Render (core1): %u quadros | trabalho max %u us | retratos descartados %u, pulados %u\n",
+        (uint)render_frames,
+        (uint)render_work_max_us,
+        (uint)render_queue.dropped,
+        (uint)render_queue.skipped);
+    printf("Botoes: %u eventos | borda max %u us | amostragem do debounce max %u us | eventos perdidos %u\n",
+        (uint)input_queue.isr_count,
+        (uint)debounce_edge_max_us,
+        (uint)debounce_tick_max_us,
+        (uint)input_queue.overflows);
+    printf("Matriz: %u quadros animados | %u adiados | quadro do alarme max %u us\n",
+        (uint)led_anim_frames,
+        (uint)led_anim_deferred,
+        (uint)led_anim_tick_max_us);
+    oled_bus_report(&oled_bus);
+    printf("Console: %u linhas descartadas\n", (uint)console_queue.dropped);
+    power_report(&power);
+    task_report("core0", core0_tasks, 3);
+    task_report("core1", core1_tasks, 2);
+    trace_report();
+}
 
-    // normaliza a distância do centro para a faixa [-1, 1]
-    float max_displacement_x = 2049.0f;
-    float max_displacement_y = 2107.0f;
-    float normalized_x = (float)x_diff / max_displacement_x;
-    float normalized_y = (float)y_diff / max_displacement_y;
+// tarefa dos quadros (core0): a cada marca do escalonador lê o joystick e publica o retrato
+task_state_t frame_task(task_t *task) {
+    TASK_BEGIN(task);
+    while (true) {
+        TASK_WAIT_UNTIL(task, scheduler_pending(&scheduler));
+        scheduler_wait(&scheduler);
+
+        TRACE_BEGIN(STAGE_CORE0_FRAME);
+
+        // trata as pressões de botão registradas desde a última rodada da tarefa de entrada
+        TRACE_BEGIN(STAGE_INPUT_EVENTS);
+        process_input_events();
+        TRACE_END(STAGE_INPUT_EVENTS);
+
+        // lê os eixos x e y já sobreamostrados
+        uint16_t x_value;
+        uint16_t y_value;
+        TRACE_BEGIN(STAGE_JOYSTICK_READ);
+        joystick_read(&x_value, &y_value);
+        TRACE_END(STAGE_JOYSTICK_READ);
+
+        int16_t new_x;
+        int16_t new_y;
+        TRACE_BEGIN(STAGE_SQUARE_POSITION);
+        square_position(x_value, y_value, &new_x, &new_y);
+        TRACE_END(STAGE_SQUARE_POSITION);
+        if (abs(new_x - activity_square_x) > SQUARE_ACTIVITY_PX || abs(new_y - activity_square_y) > SQUARE_ACTIVITY_PX) {
+            power_activity(&power);
+            activity_square_x = new_x;
+            activity_square_y = new_y;
+        }
+        publish_snapshot(new_x, new_y);
 
-    // calcula a nova posição do quadrado que está centrado inicialmente em (60, 28)
-    int new_x = 60 + (int)(normalized_x * 60.0f);
-    int new_y = 28 + (int)(normalized_y * 28.0f);
+        TRACE_END(STAGE_CORE0_FRAME);
+        scheduler_frame_done(&scheduler);
+        if (scheduler.report_frames >= SCHEDULER_REPORT_FRAMES) {
+            print_report();
+        }
 
-    // limita as posições para o tamnho da tela
-    new_x = (new_x < 0) ? 0 : (new_x > 120) ? 120 : new_x;
-    new_y = (new_y < 0) ? 0 : (new_y > 56) ? 56 : new_y;
+        // comandos e pedidos de trace recebidos pela serial, um comando por quadro: o resto fica no
+        // buffer da stdio enquanto o core1 esvazia a fila do console
+        if (read_command_line()) {
+            run_command(command_line);
+        }
+    }
+    TASK_END(task);
+}
+
+// tarefa de energia (core0): sem botões nem movimento do joystick por POWER_IDLE_TIMEOUT_MS, pede
+// ao core1 que desligue as saídas, para o escalonador e a captura do joystick, baixa o clock e dorme
+// até um botão ou o joystick sair do repouso. Sem o timer dos quadros, o núcleo só acorda com as
+// interrupções dos botões e com a amostragem lenta do ADC
+task_state_t power_task(task_t *task) {
+    TASK_BEGIN(task);
+    while (true) {
+        TASK_WAIT_UNTIL(task, power_idle_due(&power));
+
+        // os pedidos de dormir e de acordar não podem ser descartados: cede a vez até o core1 liberar
+        // a fila
+        awake = false;
+        TASK_WAIT_UNTIL(task, publish_snapshot(published_square_x, published_square_y));
+        TASK_WAIT_UNTIL(task, render_asleep);
+
+        scheduler_stop(&scheduler);
+        uint16_t rest_x;
+        uint16_t rest_y;
+        joystick_read(&rest_x, &rest_y);
+        joystick_suspend();
+        printf("Ocioso: display e matriz desligados\n");
+        power_enter_idle(&power, rest_x, rest_y);
+
+        while (true) {
+            if (!input_queue_empty(&input_queue)) {
+                wake_source = POWER_WAKE_INPUT;
+                break;
+            }
+            if (power_poll_due(&power)) {
+                uint16_t x_value;
+                uint16_t y_value;
+                joystick_sample(&x_value, &y_value);
+                if (power_adc_moved(&power, x_value, y_value)) {
+                    wake_source = POWER_WAKE_ADC;
+                    break;
+                }
+            }
+            task->wake_us = power.next_poll_us;
+            TASK_PAUSE(task);
+        }
+        task->wake_us = 0;
+
+        power_exit_idle(&power, wake_source);
+        joystick_resume();
+        scheduler_start(&scheduler);
 
-    // cria o quadrado 8X8
-    ssd1306_rect(&ssd, new_y, new_x, 8, 8, true, true);
+        // o retrato acordado religa as saídas; os eventos do botão que acordou são tratados em seguida
+        awake = true;
+        TASK_WAIT_UNTIL(task, publish_snapshot(published_square_x, published_square_y));
+        printf("Despertar: %s\n", wake_source == POWER_WAKE_INPUT ? "botao" : "joystick");
+    }
+    TASK_END(task);
 }
 
 int main() {
@@ -256,8 +760,8 @@ int main() {
     // inicializa o display OLED
     display_init();
 
-    // chama a função que inicializa o adc
-    adc_setup();
+    // inicia a captura contínua dos eixos do joystick
+    joystick_init(JOYSTICK_X, JOYSTICK_Y);
 
     // inicializa os LEDs RGB
     gpio_init(LED_R);
@@ -273,10 +777,17 @@ int main() {
     btn_init(BTN_B);
     btn_init(JOYSTICK_SW);
 
-    // configuração da interrupção para o botão A, B e SW
-    gpio_set_irq_enabled_with_callback(BTN_A, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
-    gpio_set_irq_enabled(BTN_B, GPIO_IRQ_EDGE_FALL, true);
-    gpio_set_irq_enabled(JOYSTICK_SW, GPIO_IRQ_EDGE_FALL, true);
+    // debounce dos botões: A e B repetem enquanto seguros
+    input_queue_init(&input_queue);
+    debounce_init(&input_queue);
+    debounce_add(BTN_A, true);
+    debounce_add(BTN_B, true);
+    debounce_add(JOYSTICK_SW, false);
+
+    // configuração da interrupção para o botão A, B e SW. As duas bordas acordam o debounce
+    gpio_set_irq_enabled_with_callback(BTN_A, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &gpio_irq_handler);
+    gpio_set_irq_enabled(BTN_B, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+    gpio_set_irq_enabled(JOYSTICK_SW, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
 
     //Inicializa a matriz de LEDs
     matrizInit(LED_PIN, leds);
@@ -285,56 +796,21 @@ int main() {
     npClear(leds);
     matrizWrite(leds);
 
-    // Configuração do buzzer
-    buzzer_init();
-
-    while (true) {
-        // define o tipo de borda
-        set_display_border();
-
-        // Limpa a matriz de LEDs
-        npClear(leds);
-
-        // aplica o estado atual para os LED
-        if (led_rgb_state) {
-            gpio_put(LED_G, 1);
-            gpio_put(LED_R, 0);
-        } else {
-            gpio_put(LED_R, 1);
-            gpio_put(LED_G, 0);
-        }
-
-        // realiza leitura para o eixo x
-        uint16_t x_value = adc_start_read(1);
-        // converte o valor para controle da intensidade do led vermelho tomado como menor intensidade a posição central
-        uint16_t x_value_converted = adc_convert_value(central_x_pos, x_value);
-
-        // realiza leitura para o eixo y
-        uint16_t y_value = adc_start_read(0);
-
-        // converte o valor para controle da intensidade do led azul tomado como menor intensidade a posição central
-        uint16_t y_value_converted = adc_convert_value(central_y_pos, y_value);
+    // inicia o trace dos estágios; o core1 inicia o próprio contador ao começar
+    trace_init(stage_names, STAGE_COUNT);
+    trace_core_init();
 
-        // chama a função que calcula a nova posição do quadrado de acordo com as coordenadas do joystick
-        move_square(x_value, y_value);
+    // a partir daqui display, matriz de LEDs e buzzer pertencem ao core1
+    render_queue_init(&render_queue);
+    console_queue_init(&console_queue);
+    multicore_launch_core1(core1_main);
 
-        // atualiza o display OLED
-        ssd1306_send_data(&ssd);
+    // inicia o escalonador de quadros e a contagem de inatividade
+    scheduler_init(&scheduler, FRAME_PERIOD_US);
+    power_init(&power);
 
-        if (led_rgb_state) {
-            insert_sprite(volume_scale);
-        } else {
-            npClear(leds);
-        }
-
-        define_buzzer_state();
-
-        // Atualiza a matriz de LEDs
-        matrizWrite(leds);
-
-        // adiciona um atraso de 60ms para criar tempo para vizualização dos dados no monitor serial
-        sleep_ms(60);
-    }
+    // a partir daqui o core0 só roda as tarefas de entrada, dos quadros e de energia
+    task_run(core0_tasks, 3);
 
     return 0;
 }
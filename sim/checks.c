@@ -0,0 +1,731 @@
+// Verificações dos módulos da lib na simulação em host, sem o main.c: cada caso monta um cenário
+// sobre os periféricos de sim.c, confere o resultado e imprime os números medidos. O programa
+// termina com código 1 se alguma verificação falhar (ctest, ou o alvo run_checks).
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+#include "lib/debounce.h"
+#include "lib/joystick.h"
+#include "lib/led_anim.h"
+#include "lib/leds_matrix.h"
+#include "lib/power.h"
+#include "lib/oled_bus.h"
+#include "lib/ssd1306.h"
+#include "sim.h"
+
+#define CHECK_ADDR 0x3C
+#define CHECK_SECOND_ADDR 0x3D
+
+static uint checks;
+static uint failures;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(bool ok, const char *expression, int line) {
+  checks++;
+  if (!ok) {
+    failures++;
+    printf("FALHA checks.c:%d: %s\n", line, expression);
+  }
+}
+
+// a GDDRAM do SSD1306 virtual é igual à imagem composta do driver (byte 0 do buffer sem uso)
+static bool panel_matches(const ssd1306_t *ssd) {
+  for (uint x = 0; x < ssd->width; ++x)
+    if (memcmp(sim_panel_column(ssd->address, x), &ssd->frame_buffer[x * ssd->pages + 1], ssd->pages) != 0)
+      return false;
+  return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// envio por regiões sujas: mover um quadrado 8x8 custa uma fração do quadro inteiro
+
+static void check_dirty_flush(void) {
+  ssd1306_t ssd;
+  ssd1306_init(&ssd, WIDTH, HEIGHT, false, CHECK_ADDR, i2c1);
+  ssd1306_config(&ssd);
+  ssd1306_send_data(&ssd);
+  uint32_t first_bytes = ssd.stats.frame_bytes;
+
+  ssd1306_rect(&ssd, 20, 30, 8, 8, true, true);
+  ssd1306_send_data(&ssd);
+  CHECK(panel_matches(&ssd));
+
+  // o mesmo movimento enviado por regiões sujas e como quadro inteiro
+  ssd1306_rect(&ssd, 20, 30, 8, 8, false, true);
+  ssd1306_rect(&ssd, 21, 31, 8, 8, true, true);
+  ssd1306_send_data(&ssd);
+  uint32_t dirty_bytes = ssd.stats.frame_bytes;
+  uint32_t dirty_transactions = ssd.stats.frame_transactions;
+  CHECK(panel_matches(&ssd));
+
+  ssd1306_rect(&ssd, 21, 31, 8, 8, false, true);
+  ssd1306_rect(&ssd, 20, 30, 8, 8, true, true);
+  ssd1306_mark_all_dirty(&ssd);
+  ssd1306_send_data(&ssd);
+  uint32_t full_bytes = ssd.stats.frame_bytes;
+  uint32_t full_transactions = ssd.stats.frame_transactions;
+  CHECK(panel_matches(&ssd));
+
+  ssd1306_send_data(&ssd);
+  uint32_t idle_bytes = ssd.stats.frame_bytes;
+
+  printf("ssd1306: primeiro envio %u bytes | quadro inteiro %u bytes / %u transacoes | "
+    "quadrado movido %u bytes / %u transacoes | sem mudanca %u bytes\n",
+    (uint)first_bytes, (uint)full_bytes, (uint)full_transactions, (uint)dirty_bytes,
+    (uint)dirty_transactions, (uint)idle_bytes);
+  CHECK(full_bytes >= ssd.bufsize);
+  CHECK(dirty_bytes * 8 < full_bytes);
+  CHECK(idle_bytes == 0);
+}
+
+// ---------------------------------------------------------------------------------------------
+// dois displays no mesmo barramento: um envio por vez, na ordem de prioridade e depois de prazo
+
+// roda o gerenciador até o barramento esvaziar, como a tarefa do barramento no core1
+static void oled_bus_drain(oled_bus_t *bus) {
+  uint64_t next;
+  while ((next = oled_bus_poll(bus)) != 0)
+    sim_advance_us(next > time_us_64() ? next - time_us_64() : 1);
+}
+
+static void check_oled_bus(void) {
+  static ssd1306_t first, second;
+  ssd1306_init(&first, WIDTH, HEIGHT, false, CHECK_ADDR, i2c1);
+  ssd1306_init(&second, WIDTH, HEIGHT, false, CHECK_SECOND_ADDR, i2c1);
+  ssd1306_config(&first);
+  ssd1306_config(&second);
+
+  oled_bus_t bus;
+  oled_bus_init(&bus, i2c1, 400000);
+  int main_display = oled_bus_add(&bus, &first, 0);
+  int side_display = oled_bus_add(&bus, &second, 1);
+  CHECK(main_display == 0 && side_display == 1);
+
+  // o primeiro quadro de cada um é inteiro. O secundário tem o prazo mais próximo, mas a prioridade
+  // manda: o principal transmite primeiro e o secundário espera o barramento
+  uint64_t now = time_us_64();
+  uint32_t collisions = sim_stats.i2c_collisions;
+  ssd1306_rect(&first, 8, 8, 40, 20, true, true);
+  ssd1306_draw_string(&second, "OLED 2", 0, 0);
+  oled_bus_request(&bus, side_display, now + 10000);
+  oled_bus_request(&bus, main_display, now + 60000);
+  oled_bus_poll(&bus);
+  CHECK(bus.active == main_display);
+  CHECK(bus.devices[side_display].pending);
+  oled_bus_drain(&bus);
+  uint64_t both_us = time_us_64() - now;
+
+  CHECK(panel_matches(&first));
+  CHECK(panel_matches(&second));
+  CHECK(bus.devices[main_display].frames == 1 && bus.devices[side_display].frames == 1);
+  CHECK(bus.devices[side_display].late == 1); // começou depois dos 10 ms do prazo
+  CHECK(sim_stats.i2c_collisions == collisions);
+
+  // só o secundário mudou: o principal não ocupa o barramento
+  ssd1306_draw_string(&second, "OLED 2 ok", 0, 8);
+  oled_bus_request(&bus, main_display, time_us_64() + 60000);
+  oled_bus_request(&bus, side_display, time_us_64() + 60000);
+  oled_bus_drain(&bus);
+  CHECK(panel_matches(&second));
+  CHECK(bus.devices[main_display].frames == 1 && bus.devices[side_display].frames == 2);
+
+  // mesma prioridade: o prazo mais próximo vai primeiro
+  bus.devices[side_display].priority = 0;
+  ssd1306_rect(&first, 40, 60, 8, 8, true, true);
+  ssd1306_rect(&second, 40, 60, 8, 8, true, true);
+  oled_bus_request(&bus, main_display, time_us_64() + 60000);
+  oled_bus_request(&bus, side_display, time_us_64() + 30000);
+  oled_bus_poll(&bus);
+  CHECK(bus.active == side_display);
+  oled_bus_drain(&bus);
+  CHECK(panel_matches(&first));
+  CHECK(panel_matches(&second));
+  CHECK(sim_stats.i2c_collisions == collisions);
+
+  printf("oled_bus: dois quadros inteiros em %u us | bytes principal %u, secundario %u | colisoes %u\n",
+    (uint)both_us, (uint)bus.devices[main_display].bytes, (uint)bus.devices[side_display].bytes,
+    (uint)(sim_stats.i2c_collisions - collisions));
+}
+
+// ---------------------------------------------------------------------------------------------
+// bitmaps: blit, teste de colisão no destino e colisão entre bitmaps contra uma referência pixel a
+// pixel, com coordenadas negativas, além das bordas, deslocamentos dentro da página e última página
+// incompleta. Os bits abaixo da altura do bitmap vêm acesos de propósito e devem ser ignorados
+
+static const uint8_t sprite_data[] = {
+  0x3C, 0x42, 0x81, 0x42, 0x3C, // linhas 0..7
+  0xF9, 0xFA, 0xFC, 0xFA, 0xF9, // linhas 8..10 (bits 3..7 fora do bitmap)
+};
+static const uint8_t sprite_mask[] = {
+  0x3C, 0x7E, 0xFF, 0x7E, 0x3C,
+  0xFB, 0xFB, 0xFF, 0xFB, 0xFB,
+};
+static const uint8_t block_data[] = {
+  0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55,
+  0xFF, 0xFE, 0xFF, 0xFE, 0xFF, 0xFE, 0xFF, // linha 8 só (bits 1..7 fora do bitmap)
+};
+
+static bool bitmap_bit(const ssd1306_bitmap_t *bitmap, const uint8_t *bits, int i, int j) {
+  return bits[(j >> 3) * bitmap->width + i] >> (j & 7) & 1;
+}
+
+static bool bitmap_opaque(const ssd1306_bitmap_t *bitmap, int i, int j) {
+  return bitmap_bit(bitmap, bitmap->mask ? bitmap->mask : bitmap->data, i, j);
+}
+
+static bool screen_pixel(const ssd1306_t *ssd, int x, int y) {
+  return ssd->ram_buffer[(x << 3) + (y >> 3) + 1] >> (y & 7) & 1;
+}
+
+static bool pattern_pixel(int x, int y) {
+  return (x * 3 + y * 5) % 7 < 3;
+}
+
+static void draw_pattern(ssd1306_t *ssd) {
+  for (int x = 0; x < ssd->width; ++x)
+    for (int y = 0; y < ssd->height; ++y)
+      ssd1306_pixel(ssd, x, y, pattern_pixel(x, y));
+}
+
+static uint16_t blit_test_reference(const ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y) {
+  uint16_t hits = 0;
+  for (int i = 0; i < bitmap->width; ++i)
+    for (int j = 0; j < bitmap->height; ++j)
+      if (x + i >= 0 && x + i < ssd->width && y + j >= 0 && y + j < ssd->height &&
+          bitmap_opaque(bitmap, i, j) && screen_pixel(ssd, x + i, y + j))
+        hits++;
+  return hits;
+}
+
+static bool collide_reference(const ssd1306_bitmap_t *a, int ax, int ay, const ssd1306_bitmap_t *b, int bx, int by) {
+  for (int i = 0; i < a->width; ++i) {
+    for (int j = 0; j < a->height; ++j) {
+      int bi = ax + i - bx, bj = ay + j - by;
+      if (bi >= 0 && bi < b->width && bj >= 0 && bj < b->height &&
+          bitmap_opaque(a, i, j) && bitmap_opaque(b, bi, bj))
+        return true;
+    }
+  }
+  return false;
+}
+
+// depois de um REPLACE: dentro do bitmap e opaco, o pixel do bitmap; fora, o padrão de fundo
+static bool replace_matches(const ssd1306_t *ssd, const ssd1306_bitmap_t *bitmap, int x, int y) {
+  for (int sx = 0; sx < ssd->width; ++sx) {
+    for (int sy = 0; sy < ssd->height; ++sy) {
+      int i = sx - x, j = sy - y;
+      bool covered = i >= 0 && i < bitmap->width && j >= 0 && j < bitmap->height &&
+        (!bitmap->mask || bitmap_bit(bitmap, bitmap->mask, i, j));
+      if (screen_pixel(ssd, sx, sy) != (covered ? bitmap_bit(bitmap, bitmap->data, i, j) : pattern_pixel(sx, sy)))
+        return false;
+    }
+  }
+  return true;
+}
+
+#define CHECK_BITMAPS 3
+
+static void check_bitmaps(void) {
+  static ssd1306_t ssd;
+  ssd1306_init(&ssd, WIDTH, HEIGHT, false, CHECK_ADDR, i2c1);
+  const ssd1306_bitmap_t masked = { 5, 11, sprite_data, sprite_mask };
+  const ssd1306_bitmap_t unmasked = { 5, 11, sprite_data, NULL };
+  const ssd1306_bitmap_t block = { 7, 9, block_data, NULL };
+  const ssd1306_bitmap_t *bitmaps[CHECK_BITMAPS] = { &masked, &unmasked, &block };
+
+  // ssd1306_blit_test em todas as posições que ainda tocam a tela, e um pouco além
+  draw_pattern(&ssd);
+  uint positions = 0, test_mismatches = 0;
+  for (uint b = 0; b < CHECK_BITMAPS; ++b) {
+    for (int x = -bitmaps[b]->width - 1; x <= WIDTH + 1; ++x) {
+      for (int y = -bitmaps[b]->height - 1; y <= HEIGHT + 1; ++y) {
+        positions++;
+        if (ssd1306_blit_test(&ssd, bitmaps[b], x, y) != blit_test_reference(&ssd, bitmaps[b], x, y))
+          test_mismatches++;
+      }
+    }
+  }
+  CHECK(test_mismatches == 0);
+  // com máscara contam os pixels da máscara; sem ela, só os acesos do bitmap
+  CHECK(ssd1306_blit_test(&ssd, &masked, 20, 20) != ssd1306_blit_test(&ssd, &unmasked, 20, 20));
+
+  // REPLACE recortado nos quatro cantos e com deslocamento dentro da página
+  static const int spots[][2] = { { -3, -5 }, { -2, HEIGHT - 4 }, { WIDTH - 2, -9 }, { WIDTH - 3, HEIGHT - 6 }, { 17, 3 } };
+  for (uint b = 0; b < 2; ++b) {
+    for (uint s = 0; s < sizeof(spots) / sizeof(spots[0]); ++s) {
+      draw_pattern(&ssd);
+      ssd1306_blit(&ssd, bitmaps[b], spots[s][0], spots[s][1], SSD1306_BLIT_REPLACE);
+      CHECK(replace_matches(&ssd, bitmaps[b], spots[s][0], spots[s][1]));
+    }
+  }
+
+  // XOR duas vezes no mesmo lugar, parcialmente fora da tela, devolve o fundo
+  draw_pattern(&ssd);
+  ssd1306_blit(&ssd, &block, -4, -6, SSD1306_BLIT_XOR);
+  ssd1306_blit(&ssd, &block, -4, -6, SSD1306_BLIT_XOR);
+  CHECK(replace_matches(&ssd, &(ssd1306_bitmap_t){ 0, 0, NULL, NULL }, 0, 0));
+
+  // ssd1306_bitmaps_collide com um bitmap em coordenadas negativas e o outro em volta dele
+  uint collide_mismatches = 0, collisions = 0;
+  for (uint a = 0; a < CHECK_BITMAPS; ++a) {
+    for (uint b = 0; b < CHECK_BITMAPS; ++b) {
+      for (int dx = -9; dx <= 9; ++dx) {
+        for (int dy = -13; dy <= 13; ++dy) {
+          bool hit = ssd1306_bitmaps_collide(bitmaps[a], -3, -4, bitmaps[b], -3 + dx, -4 + dy);
+          if (hit != collide_reference(bitmaps[a], -3, -4, bitmaps[b], -3 + dx, -4 + dy) ||
+              hit != ssd1306_bitmaps_collide(bitmaps[b], -3 + dx, -4 + dy, bitmaps[a], -3, -4))
+            collide_mismatches++;
+          collisions += hit;
+        }
+      }
+    }
+  }
+  CHECK(collide_mismatches == 0);
+  // o bloco em (0, 9) fica no xadrez com os pixels acesos das linhas 9 e 10 do sprite, mas a máscara,
+  // opaca na linha 9 inteira, encosta nele
+  CHECK(ssd1306_bitmaps_collide(&masked, 0, 0, &block, 0, 9));
+  CHECK(!ssd1306_bitmaps_collide(&unmasked, 0, 0, &block, 0, 9));
+
+  printf("bitmaps: blit_test em %u posicoes | colisao em %u de %u pares deslocados\n",
+    positions, collisions, (uint)(CHECK_BITMAPS * CHECK_BITMAPS * 19 * 27));
+}
+
+// ---------------------------------------------------------------------------------------------
+// mapeamento do joystick: Q12 contra o caminho em float que ele substituiu, medidos no host
+
+static double host_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define JOYSTICK_CHECK_ROUNDS 200
+
+static void check_joystick_map(void) {
+  // o roteiro de sim.c deixa o joystick solto no centro a partir de 8 s: a calibração mede o repouso
+  sim_advance_us(SIM_JOYSTICK_REST_US + 1000000);
+  joystick_init(27, 26);
+
+  // a medição do comando "joy" varre a faixa inteira do ADC, além dos extremos calibrados: a
+  // calibração tem de voltar como estava
+  int x, y;
+  joystick_map(3000, 1000, &x, &y);
+  int before_x = x, before_y = y;
+  uint32_t fixed_cycles, float_cycles;
+  joystick_measure(&fixed_cycles, &float_cycles);
+  joystick_map(3000, 1000, &x, &y);
+  CHECK(x == before_x && y == before_y);
+
+  joystick_map(2048, 2048, &x, &y);
+  CHECK(x == 60 && y == 28);
+  joystick_map(4095, 0, &x, &y);
+  CHECK(x == 120 && y == 56);
+  joystick_map(0, 4095, &x, &y);
+  CHECK(x == 0 && y == 0);
+
+  // varredura da faixa do ADC com os dois eixos em sentidos opostos; a soma impede o compilador de
+  // descartar as chamadas
+  volatile int sink = 0;
+  double start = host_ns();
+  for (uint round = 0; round < JOYSTICK_CHECK_ROUNDS; ++round) {
+    for (uint value = 0; value < 4096; ++value) {
+      joystick_map(value, 4095 - value, &x, &y);
+      sink += x + y;
+    }
+  }
+  double fixed_ns = (host_ns() - start) / (JOYSTICK_CHECK_ROUNDS * 4096.0);
+
+  start = host_ns();
+  for (uint round = 0; round < JOYSTICK_CHECK_ROUNDS; ++round) {
+    for (uint value = 0; value < 4096; ++value) {
+      joystick_map_float(value, 4095 - value, &x, &y);
+      sink += x + y;
+    }
+  }
+  double float_ns = (host_ns() - start) / (JOYSTICK_CHECK_ROUNDS * 4096.0);
+
+  // o host tem FPU; no RP2040 (Cortex-M0+) cada operação em float é uma rotina de software. Os ciclos
+  // no alvo vêm do comando "joy" do console
+  printf("joystick: joystick_map Q12 %.1f ns | float antigo %.1f ns (por par de eixos, no host)\n",
+    fixed_ns, float_ns);
+}
+
+// ---------------------------------------------------------------------------------------------
+// fill, rect, hline e vline por faixas de bytes de página: mesmos pixels das versões antigas, que
+// desenhavam pixel a pixel com ssd1306_pixel, e o tempo de cada uma no host
+
+static void pixel_fill(ssd1306_t *ssd, bool value) {
+  for (uint8_t y = 0; y < ssd->height; ++y)
+    for (uint8_t x = 0; x < ssd->width; ++x)
+      ssd1306_pixel(ssd, x, y, value);
+}
+
+static void pixel_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  for (uint8_t x = left; x < left + width; ++x) {
+    ssd1306_pixel(ssd, x, top, value);
+    ssd1306_pixel(ssd, x, top + height - 1, value);
+  }
+  for (uint8_t y = top; y < top + height; ++y) {
+    ssd1306_pixel(ssd, left, y, value);
+    ssd1306_pixel(ssd, left + width - 1, y, value);
+  }
+  if (fill) {
+    for (uint8_t x = left + 1; x < left + width - 1; ++x)
+      for (uint8_t y = top + 1; y < top + height - 1; ++y)
+        ssd1306_pixel(ssd, x, y, value);
+  }
+}
+
+static void pixel_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+  for (uint8_t x = x0; x <= x1; ++x)
+    ssd1306_pixel(ssd, x, y, value);
+}
+
+static void pixel_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+  for (uint8_t y = y0; y <= y1; ++y)
+    ssd1306_pixel(ssd, x, y, value);
+}
+
+// coordenada aleatória que às vezes passa da borda (sem chegar a 255, onde os laços antigos não
+// terminam)
+static uint8_t random_coordinate(uint limit) {
+  return rand() % (limit + 8);
+}
+
+typedef struct {
+  const char *name;
+  void (*span)(ssd1306_t *ssd, bool value);
+  void (*pixel)(ssd1306_t *ssd, bool value);
+} span_workload_t;
+
+static void span_fill(ssd1306_t *ssd, bool value) { ssd1306_fill(ssd, value); }
+static void pixel_fill_workload(ssd1306_t *ssd, bool value) { pixel_fill(ssd, value); }
+static void span_rect8(ssd1306_t *ssd, bool value) { ssd1306_rect(ssd, 21, 37, 8, 8, value, true); }
+static void pixel_rect8(ssd1306_t *ssd, bool value) { pixel_rect(ssd, 21, 37, 8, 8, value, true); }
+static void span_outline(ssd1306_t *ssd, bool value) { ssd1306_rect(ssd, 1, 1, 126, 62, value, false); }
+static void pixel_outline(ssd1306_t *ssd, bool value) { pixel_rect(ssd, 1, 1, 126, 62, value, false); }
+static void span_hline(ssd1306_t *ssd, bool value) { ssd1306_hline(ssd, 0, WIDTH - 1, 29, value); }
+static void pixel_hline_workload(ssd1306_t *ssd, bool value) { pixel_hline(ssd, 0, WIDTH - 1, 29, value); }
+static void span_vline(ssd1306_t *ssd, bool value) { ssd1306_vline(ssd, 77, 0, HEIGHT - 1, value); }
+static void pixel_vline_workload(ssd1306_t *ssd, bool value) { pixel_vline(ssd, 77, 0, HEIGHT - 1, value); }
+
+static const span_workload_t span_workloads[] = {
+  { "fill", span_fill, pixel_fill_workload },
+  { "rect 8x8 cheio", span_rect8, pixel_rect8 },
+  { "contorno 126x62", span_outline, pixel_outline },
+  { "hline inteira", span_hline, pixel_hline_workload },
+  { "vline inteira", span_vline, pixel_vline_workload },
+};
+
+#define SPAN_CHECK_CALLS 20000
+#define SPAN_TIMING_CALLS 2000
+
+static double span_time_ns(ssd1306_t *ssd, void (*draw)(ssd1306_t *ssd, bool value)) {
+  double start = host_ns();
+  for (uint i = 0; i < SPAN_TIMING_CALLS; ++i)
+    draw(ssd, i & 1);
+  return (host_ns() - start) / SPAN_TIMING_CALLS;
+}
+
+static void check_draw_spans(void) {
+  static ssd1306_t spans, pixels;
+  ssd1306_init(&spans, WIDTH, HEIGHT, false, CHECK_ADDR, i2c1);
+  ssd1306_init(&pixels, WIDTH, HEIGHT, false, CHECK_ADDR, i2c1);
+
+  // chamadas aleatórias nos dois buffers, conferidos byte a byte depois de cada uma. Retângulos têm
+  // ao menos 1x1: os vazios não desenham nada agora, e antes desenhavam colunas soltas
+  srand(4);
+  uint mismatches = 0;
+  for (uint call = 0; call < SPAN_CHECK_CALLS; ++call) {
+    bool value = rand() & 1;
+    switch (rand() % 8) {
+      case 0:
+        ssd1306_fill(&spans, value);
+        pixel_fill(&pixels, value);
+        break;
+      case 1:
+      case 2:
+      case 3: {
+        uint8_t top = random_coordinate(HEIGHT), left = random_coordinate(WIDTH);
+        uint8_t width = 1 + rand() % (WIDTH - 8), height = 1 + rand() % HEIGHT;
+        bool fill = rand() & 1;
+        ssd1306_rect(&spans, top, left, width, height, value, fill);
+        pixel_rect(&pixels, top, left, width, height, value, fill);
+        break;
+      }
+      case 4:
+      case 5: {
+        uint8_t x0 = random_coordinate(WIDTH), x1 = random_coordinate(WIDTH), y = random_coordinate(HEIGHT);
+        ssd1306_hline(&spans, x0, x1, y, value);
+        pixel_hline(&pixels, x0, x1, y, value);
+        break;
+      }
+      default: {
+        uint8_t x = random_coordinate(WIDTH), y0 = random_coordinate(HEIGHT), y1 = random_coordinate(HEIGHT);
+        ssd1306_vline(&spans, x, y0, y1, value);
+        pixel_vline(&pixels, x, y0, y1, value);
+        break;
+      }
+    }
+    if (memcmp(spans.ram_buffer, pixels.ram_buffer, spans.bufsize) != 0) {
+      mismatches++;
+      memcpy(pixels.ram_buffer, spans.ram_buffer, spans.bufsize);
+    }
+  }
+  CHECK(mismatches == 0);
+
+  printf("desenho: %u chamadas aleatorias iguais ao pixel a pixel | ns por chamada, pixel a pixel -> faixas:",
+    SPAN_CHECK_CALLS - mismatches);
+  for (uint i = 0; i < sizeof(span_workloads) / sizeof(span_workloads[0]); ++i) {
+    double pixel_ns = span_time_ns(&pixels, span_workloads[i].pixel);
+    double span_ns = span_time_ns(&spans, span_workloads[i].span);
+    printf("%s %s %.0f -> %.0f", i ? " |" : "", span_workloads[i].name, pixel_ns, span_ns);
+    CHECK(span_ns < pixel_ns);
+  }
+  printf(" (no host)\n");
+}
+
+// ---------------------------------------------------------------------------------------------
+// debounce: um alvo de alarme já passado não pode deixar a amostragem parada
+
+#define CHECK_BUTTON 5
+
+// eventos do debounce, também usados pela verificação do modo ocioso
+static input_queue_t queue;
+
+static void check_debounce_missed_alarm(void) {
+  input_queue_init(&queue);
+  gpio_pull_up(CHECK_BUTTON);
+  debounce_init(&queue);
+  debounce_add(CHECK_BUTTON, false);
+
+  input_event_t event = { 0 };
+  for (uint round = 0; round < 2; ++round) {
+    // na primeira pressão o alvo perdido é o da borda; na segunda, o da primeira amostra
+    gpio_put(CHECK_BUTTON, false);
+    sim_alarm_misses = round == 0;
+    debounce_edge(CHECK_BUTTON);
+    sim_alarm_misses = round == 1;
+    sim_advance_us(10 * DEBOUNCE_SAMPLE_US);
+    CHECK(sim_alarm_misses == 0);
+    CHECK(input_queue_pop(&queue, &event) && event.events == INPUT_EVENT_PRESS);
+
+    gpio_put(CHECK_BUTTON, true);
+    sim_advance_us(10 * DEBOUNCE_SAMPLE_US);
+    CHECK(input_queue_pop(&queue, &event) && event.events == INPUT_EVENT_RELEASE);
+  }
+}
+
+// ---------------------------------------------------------------------------------------------
+// animação da matriz: com o envio anterior em andamento o alarme adia o quadro, sem escrever no fio
+
+#define CHECK_LEDS 4
+
+static bool matrix_ready;
+static uint32_t matrix_wire[CHECK_LEDS];
+static uint matrix_sends;
+
+static bool check_matrix_ready(void) {
+  return matrix_ready;
+}
+
+static uint32_t *check_matrix_begin(void) {
+  CHECK(matrix_ready);
+  return matrix_wire;
+}
+
+static void check_matrix_end(void) {
+  CHECK(matrix_ready);
+  matrix_sends++;
+}
+
+static void check_led_anim_defer(void) {
+  static const uint32_t lit[CHECK_LEDS] = { 0xFF000000, 0x00FF0000, 0x0000FF00, 0x80808000 };
+  static const uint32_t dark[CHECK_LEDS] = { 0 };
+  led_anim_init(CHECK_LEDS, check_matrix_ready, check_matrix_begin, check_matrix_end);
+
+  // troca sem fade com a matriz ocupada: led_anim_show não envia e o alarme só adia
+  matrix_ready = false;
+  led_anim_show(lit, 0, LED_ANIM_EASE_LINEAR);
+  CHECK(matrix_sends == 0);
+  sim_advance_us(LED_ANIM_FRAME_US);
+  CHECK(matrix_sends == 0);
+  uint32_t deferred = led_anim_deferred;
+  CHECK(deferred >= LED_ANIM_FRAME_US / LED_ANIM_RETRY_US - 1);
+
+  matrix_ready = true;
+  sim_advance_us(LED_ANIM_RETRY_US);
+  CHECK(matrix_sends == 1 && memcmp(matrix_wire, lit, sizeof(lit)) == 0);
+
+  // fade até apagar com a matriz livre: nenhum quadro adiado
+  led_anim_show(dark, 100, LED_ANIM_EASE_LINEAR);
+  sim_advance_us(200000);
+  CHECK(!led_anim_busy());
+  CHECK(memcmp(matrix_wire, dark, sizeof(dark)) == 0);
+  CHECK(led_anim_deferred == deferred);
+
+  printf("led_anim: %u quadros adiados com a matriz ocupada | %u enviados no fade\n",
+    (uint)deferred, matrix_sends - 1);
+}
+
+// ---------------------------------------------------------------------------------------------
+// modo ocioso: o roteiro de sim.c deixa o joystick solto de 8 s a 80 s e aperta B aos 44 s. Os passos
+// são os de power_task e render_task em main.c, com os mesmos módulos; confere-se o que chega ao
+// painel, ao fio da matriz e aos contadores de power_t
+
+#define CHECK_WAKE_BUTTON 6
+#define CHECK_FRAME_US 60000 // FRAME_PERIOD_US de main.c
+#define CHECK_IDLE_STEP_US 1000 // o núcleo em WFE reavalia a cada interrupção; aqui, a cada 1 ms
+#define CHECK_WAKE_LATENCY_MAX_US 20000
+
+static void check_gpio_irq(uint gpio, uint32_t events) {
+  (void)events;
+  debounce_edge(gpio);
+}
+
+// quadros normais até vencer o tempo sem atividade; os eventos dos botões contam como atividade,
+// como na tarefa de entrada. Devolve o tempo desde a última atividade
+static uint64_t power_run_until_idle(power_t *power) {
+  input_event_t event;
+  while (true) {
+    while (input_queue_pop(&queue, &event))
+      power_activity(power);
+    if (power_idle_due(power))
+      return time_us_64() - power->last_activity_us;
+    sim_advance_us(CHECK_FRAME_US);
+  }
+}
+
+// saídas do retrato de dormir: display e charge pump desligados e a matriz apagada numa escrita
+static void power_sleep_outputs(ssd1306_t *ssd, ws2812_t *matrix) {
+  ssd1306_power(ssd, false);
+  memset(ws2812_begin_frame(matrix), 0, LED_COUNT * sizeof(uint32_t));
+  ws2812_end_frame(matrix);
+  sim_advance_us(matrix->frame_us + WS2812_RESET_US);
+}
+
+// dorme como power_task até um evento de botão ou o joystick sair do repouso
+static power_wake_t power_sleep(power_t *power) {
+  uint16_t rest_x, rest_y;
+  joystick_read(&rest_x, &rest_y);
+  joystick_suspend();
+  power_enter_idle(power, rest_x, rest_y);
+  CHECK(clock_get_hz(clk_sys) == 48000000);
+
+  power_wake_t source;
+  while (true) {
+    if (!input_queue_empty(&queue)) {
+      source = POWER_WAKE_INPUT;
+      break;
+    }
+    if (power_poll_due(power)) {
+      uint16_t x_value, y_value;
+      joystick_sample(&x_value, &y_value);
+      if (power_adc_moved(power, x_value, y_value)) {
+        source = POWER_WAKE_ADC;
+        break;
+      }
+    }
+    sim_advance_us(CHECK_IDLE_STEP_US);
+  }
+
+  power_exit_idle(power, source);
+  joystick_resume();
+  return source;
+}
+
+// primeiro quadro depois do despertar, como render_frame: religa o painel, pede o envio e registra
+static void power_wake_outputs(power_t *power, ssd1306_t *ssd) {
+  ssd1306_power(ssd, true);
+  ssd1306_rect(ssd, 20, 30, 8, 8, true, true);
+  ssd1306_send_data(ssd);
+  power_wake_frame(power);
+  ssd1306_flush_wait(ssd);
+}
+
+static void check_power_idle(void) {
+  static ssd1306_t ssd;
+  static ws2812_t matrix;
+  ssd1306_init(&ssd, WIDTH, HEIGHT, false, CHECK_ADDR, i2c1);
+  ssd1306_config(&ssd);
+  ssd1306_send_data(&ssd);
+  CHECK(ws2812_init(&matrix, &np_config));
+  gpio_pull_up(CHECK_WAKE_BUTTON);
+  debounce_add(CHECK_WAKE_BUTTON, false);
+  gpio_set_irq_enabled_with_callback(CHECK_WAKE_BUTTON, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, check_gpio_irq);
+
+  static power_t power;
+  power_init(&power);
+  CHECK(time_us_64() + POWER_IDLE_TIMEOUT_MS * 1000ull < SIM_WAKE_PRESS_US);
+
+  // primeiro ciclo: ocioso depois do tempo sem atividade, acordado pelo botão do roteiro
+  uint64_t idle_after_us = power_run_until_idle(&power);
+  CHECK(idle_after_us >= POWER_IDLE_TIMEOUT_MS * 1000ull && idle_after_us < POWER_IDLE_TIMEOUT_MS * 1000ull + CHECK_FRAME_US);
+
+  uint display_offs = sim_panel_display_offs(CHECK_ADDR);
+  uint64_t frames = sim_stats.pio_frames, dark_frames = sim_stats.pio_dark_frames;
+  power_sleep_outputs(&ssd, &matrix);
+  CHECK(!sim_panel_display_on(CHECK_ADDR) && !sim_panel_charge_pump(CHECK_ADDR));
+
+  CHECK(power_sleep(&power) == POWER_WAKE_INPUT);
+  uint64_t input_wake_us = time_us_64();
+  // a pressão é confirmada depois dos repiques e de DEBOUNCE_STABLE_SAMPLES amostras
+  CHECK(input_wake_us >= SIM_WAKE_PRESS_US && input_wake_us < SIM_WAKE_PRESS_US + 10 * DEBOUNCE_SAMPLE_US);
+  CHECK(power.wakes_input == 1 && power.wakes_adc == 0);
+  CHECK(clock_get_hz(clk_sys) == POWER_ACTIVE_KHZ * 1000);
+  // durante o ocioso o painel recebeu um único desligamento e a matriz uma única escrita, apagada
+  CHECK(sim_panel_display_offs(CHECK_ADDR) == display_offs + 1);
+  CHECK(sim_stats.pio_frames == frames + 1 && sim_stats.pio_dark_frames == dark_frames + 1);
+
+  power_wake_outputs(&power, &ssd);
+  CHECK(sim_panel_display_on(CHECK_ADDR) && sim_panel_charge_pump(CHECK_ADDR));
+  CHECK(panel_matches(&ssd));
+  uint32_t input_latency_us = power.wake_latency_us;
+  CHECK(input_latency_us > 0 && input_latency_us < CHECK_WAKE_LATENCY_MAX_US);
+
+  // segundo ciclo: ocioso de novo, acordado pelo joystick quando o roteiro volta a movê-lo
+  idle_after_us = power_run_until_idle(&power);
+  CHECK(idle_after_us >= POWER_IDLE_TIMEOUT_MS * 1000ull && idle_after_us < POWER_IDLE_TIMEOUT_MS * 1000ull + CHECK_FRAME_US);
+  CHECK(time_us_64() < SIM_JOYSTICK_MOVE_US);
+  display_offs = sim_panel_display_offs(CHECK_ADDR);
+  frames = sim_stats.pio_frames;
+  dark_frames = sim_stats.pio_dark_frames;
+  power_sleep_outputs(&ssd, &matrix);
+  CHECK(!sim_panel_display_on(CHECK_ADDR) && !sim_panel_charge_pump(CHECK_ADDR));
+  CHECK(power_sleep(&power) == POWER_WAKE_ADC);
+  uint64_t adc_wake_us = time_us_64();
+  CHECK(adc_wake_us >= SIM_JOYSTICK_MOVE_US && adc_wake_us <= SIM_JOYSTICK_MOVE_US + POWER_ADC_POLL_MS * 1000 + CHECK_IDLE_STEP_US);
+  CHECK(power.wakes_input == 1 && power.wakes_adc == 1);
+  CHECK(sim_panel_display_offs(CHECK_ADDR) == display_offs + 1);
+  CHECK(sim_stats.pio_frames == frames + 1 && sim_stats.pio_dark_frames == dark_frames + 1);
+
+  power_wake_outputs(&power, &ssd);
+  CHECK(power.wake_latency_us > 0 && power.wake_latency_us < CHECK_WAKE_LATENCY_MAX_US);
+  CHECK(power.wake_latency_max_us >= input_latency_us && power.wake_latency_max_us >= power.wake_latency_us);
+
+  printf("energia: ocioso apos %u ms sem atividade | despertar por botao %u us depois da borda, pelo "
+    "joystick %u us depois do movimento | latencia ate o primeiro quadro %u us e %u us\n",
+    (uint)(idle_after_us / 1000), (uint)(input_wake_us - SIM_WAKE_PRESS_US),
+    (uint)(adc_wake_us - SIM_JOYSTICK_MOVE_US), (uint)input_latency_us, (uint)power.wake_latency_us);
+}
+
+int main() {
+  i2c_init(i2c1, 400000);
+
+  check_dirty_flush();
+  check_oled_bus();
+  check_bitmaps();
+  check_draw_spans();
+  check_joystick_map();
+  check_debounce_missed_alarm();
+  check_led_anim_defer();
+  check_power_idle();
+
+  printf("checks: %u verificacoes, %u falhas\n", checks, failures);
+  return failures ? 1 : 0;
+}
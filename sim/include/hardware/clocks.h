@@ -0,0 +1,10 @@
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico/stdlib.h"
+
+enum clock_index { clk_gpout0 = 0, clk_ref = 4, clk_sys = 5, clk_peri = 6, clk_usb = 7, clk_adc = 8, clk_rtc = 9 };
+
+static inline uint32_t clock_get_hz(enum clock_index clock) { return clock == clk_sys || clock == clk_peri ? sim_sys_clock_khz * 1000 : 48000000; }
+
+#endif
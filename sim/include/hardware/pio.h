@@ -0,0 +1,62 @@
+#ifndef SIM_HARDWARE_PIO_H
+#define SIM_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+  volatile uint32_t txf[4];
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t sim_pio_hw[2];
+#define pio0 (&sim_pio_hw[0])
+#define pio1 (&sim_pio_hw[1])
+
+typedef struct pio_program {
+  const uint16_t *instructions;
+  uint8_t length;
+  int8_t origin;
+} pio_program_t;
+
+typedef struct {
+  uint32_t clkdiv_x256;
+  uint sideset_base;
+  bool out_shift_right, autopull;
+  uint pull_threshold;
+  uint out_base, out_count;
+} pio_sm_config;
+
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1 : 0; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { return pio_get_index(pio) * 8 + (is_tx ? 0 : 4) + sm; }
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_gpio_init(PIO pio, uint pin);
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+const pio_sm_config *sim_pio_sm_config(PIO pio, uint sm);
+
+// codificação das instruções, para programas ajustados na carga
+enum pio_src_dest { pio_pins = 0u, pio_x = 1u, pio_y = 2u, pio_null = 3u, pio_pindirs = 4u, pio_isr = 6u, pio_osr = 7u };
+static inline uint pio_encode_out(enum pio_src_dest dest, uint count) { return 0x6000u | (dest & 7u) << 5 | (count & 31u); }
+
+static inline pio_sm_config pio_get_default_sm_config(void) { pio_sm_config c = { .clkdiv_x256 = 256, .out_shift_right = true, .pull_threshold = 32 }; return c; }
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint base) { c->sideset_base = base; }
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bits, bool optional, bool pindirs) { (void)c; (void)bits; (void)optional; (void)pindirs; }
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint base, uint count) { c->out_base = base; c->out_count = count; }
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint threshold) {
+  c->out_shift_right = shift_right;
+  c->autopull = autopull;
+  c->pull_threshold = threshold ? threshold : 32;
+}
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { (void)c; (void)join; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv_x256 = (uint32_t)(div * 256.f); }
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) { (void)c; (void)wrap_target; (void)wrap; }
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef SIM_HARDWARE_STRUCTS_SYSTICK_H
+#define SIM_HARDWARE_STRUCTS_SYSTICK_H
+
+#include "pico/stdlib.h"
+
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS 0x4u
+#define M0PLUS_SYST_CSR_ENABLE_BITS 0x1u
+
+typedef struct {
+  uint32_t csr, rvr, cvr, calib;
+} systick_hw_t;
+
+// o SysTick conta ciclos do clk_sys (125 MHz) para baixo a partir do tempo virtual
+systick_hw_t *sim_systick(void);
+#define systick_hw (sim_systick())
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+// esperar um evento passa a vez ao outro núcleo e, no core0, avança o tempo até o próximo evento agendado
+static inline void __wfe(void) { sim_idle(); }
+static inline void __wfi(void) { sim_idle(); }
+static inline void __sev(void) {}
+static inline void __dmb(void) {}
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef SIM_PICO_MULTICORE_H
+#define SIM_PICO_MULTICORE_H
+
+#include "pico/stdlib.h"
+
+// os dois núcleos rodam em threads, mas só um por vez: quem espera (sim_idle) passa a vez ao outro
+void multicore_launch_core1(void (*entry)(void));
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+// Subconjunto do pico/stdlib.h para a simulação em host. O tempo é virtual (sim_time_us) e só avança
+// quando o firmware espera (sleep, tight_loop_contents, __wfe) ou ocupa um barramento bloqueante.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+extern volatile uint64_t sim_time_us;
+void sim_advance_us(uint64_t us);
+void sim_idle(void);
+void sim_idle_until(uint64_t limit_us);
+
+static inline absolute_time_t get_absolute_time(void) { return sim_time_us; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint64_t time_us_64(void) { return sim_time_us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return sim_time_us + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return sim_time_us + ms * 1000ull; }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline uint32_t time_us_32(void) { return (uint32_t)sim_time_us; }
+static inline void sleep_us(uint64_t us) { sim_advance_us(us); }
+static inline void sleep_ms(uint32_t ms) { sim_advance_us(ms * 1000ull); }
+static inline void busy_wait_us(uint64_t us) { sim_advance_us(us); }
+static inline void tight_loop_contents(void) { sim_idle(); }
+static inline bool best_effort_wfe_or_timeout(absolute_time_t t) {
+  if (sim_time_us < t)
+    sim_idle_until(t);
+  return sim_time_us >= t;
+}
+
+// repeating timers e alarmes
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+struct repeating_timer {
+  int64_t delay_us;
+  repeating_timer_callback_t callback;
+  void *user_data;
+  uint64_t next_us;
+  bool active;
+};
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+static inline bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+  return add_repeating_timer_us(delay_ms * 1000ll, callback, user_data, out);
+}
+bool cancel_repeating_timer(repeating_timer_t *timer);
+
+// GPIO
+#define GPIO_IN false
+#define GPIO_OUT true
+enum gpio_function { GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7, GPIO_FUNC_NULL = 0x1f };
+#define GPIO_IRQ_LEVEL_LOW 0x1u
+#define GPIO_IRQ_LEVEL_HIGH 0x2u
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+
+// clk_sys: só registra a frequência, o tempo virtual não depende dela
+extern uint32_t sim_sys_clock_khz;
+static inline void set_sys_clock_48mhz(void) { sim_sys_clock_khz = 48000; }
+static inline bool set_sys_clock_khz(uint32_t freq_khz, bool required) { (void)required; sim_sys_clock_khz = freq_khz; return true; }
+
+static inline bool stdio_init_all(void) { return true; }
+#define PICO_ERROR_TIMEOUT (-1)
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+static inline void stdio_flush(void) { fflush(stdout); }
+uint get_core_num(void);
+
+#endif
@@ -0,0 +1,28 @@
+# Gera o cabeçalho de um programa .pio para a simulação em host: o bloco "% c-sdk { ... %}" é copiado
+# como está e o programa em si vira um stub, já que a PIO virtual não executa instruções.
+#   cmake -DPIO_SOURCE=<arquivo.pio> -DPIO_HEADER=<saida.h> -P pio_header.cmake
+
+file(READ ${PIO_SOURCE} source)
+
+string(REGEX MATCH "\\.program[ \t]+([A-Za-z0-9_]+)" _ "${source}")
+set(program ${CMAKE_MATCH_1})
+if(NOT program)
+    message(FATAL_ERROR "nenhum .program em ${PIO_SOURCE}")
+endif()
+
+string(REGEX MATCH "% c-sdk {\n(.*)%}" _ "${source}")
+set(c_sdk "${CMAKE_MATCH_1}")
+
+file(WRITE ${PIO_HEADER} "// gerado por sim/pio_header.cmake a partir de ${PIO_SOURCE}
+#pragma once
+#include \"hardware/pio.h\"
+
+static const uint16_t ${program}_program_instructions[] = { 0 };
+static const struct pio_program ${program}_program = { ${program}_program_instructions, 1, -1 };
+
+static inline pio_sm_config ${program}_program_get_default_config(uint offset) {
+  (void)offset;
+  return pio_get_default_sm_config();
+}
+
+${c_sdk}")
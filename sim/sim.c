@@ -0,0 +1,866 @@
+// Modelo dos periféricos do RP2040 para a simulação em host: tempo virtual, timers, I2C com um
+// SSD1306 virtual, DMA, PIO (WS2812), ADC e PWM, com contabilidade de bytes e ocupação de barramento.
+// O firmware roda sem alterações; o relatório por quadro sai depois de SIM_FRAMES quadros (1000 por
+// padrão) e a última linha (sim_result) é fácil de comparar em CI.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/i2c.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/structs/systick.h"
+#include "hardware/timer.h"
+#include "lib/assets.h"
+#include "sim.h"
+
+#define SIM_MAX_TIMERS 16
+#define SIM_WS2812_HZ 800000u
+
+volatile uint64_t sim_time_us = 0;
+uint32_t sim_sys_clock_khz = 125000;
+sim_stats_t sim_stats;
+
+static repeating_timer_t *timers[SIM_MAX_TIMERS];
+static uint timer_count = 0;
+
+// ---------------------------------------------------------------------------------------------
+// tempo virtual
+
+static void adc_stream(uint64_t now_us);
+static uint64_t sim_button_next_us(void);
+static void sim_button_edge(void);
+
+// alarmes de hardware: alvo em tempo virtual, UINT64_MAX quando desarmado
+#define SIM_ALARMS 4
+static uint64_t alarm_target_us[SIM_ALARMS] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX };
+static hardware_alarm_callback_t alarm_callbacks[SIM_ALARMS];
+static uint alarm_claimed;
+
+int hardware_alarm_claim_unused(bool required) {
+  for (uint i = 0; i < SIM_ALARMS; ++i) {
+    if (!(alarm_claimed & (1u << i))) {
+      alarm_claimed |= 1u << i;
+      return i;
+    }
+  }
+  if (required) {
+    fprintf(stderr, "sim: nenhum alarme livre\n");
+    abort();
+  }
+  return -1;
+}
+
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback) { alarm_callbacks[alarm_num] = callback; }
+
+// alvos seguintes tratados como já passados, para simular um núcleo atrasado por outra interrupção
+uint sim_alarm_misses;
+
+// como no SDK, devolve true se o alvo já passou (e o alarme não é armado)
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+  if (sim_alarm_misses) {
+    sim_alarm_misses--;
+    return true;
+  }
+  if (t <= sim_time_us)
+    return true;
+  alarm_target_us[alarm_num] = t;
+  return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) { alarm_target_us[alarm_num] = UINT64_MAX; }
+
+static uint64_t sim_next_event_us(void) {
+  uint64_t next = sim_button_next_us();
+  for (uint i = 0; i < SIM_ALARMS; ++i)
+    if (alarm_target_us[i] < next)
+      next = alarm_target_us[i];
+  for (uint i = 0; i < timer_count; ++i)
+    if (timers[i]->active && timers[i]->next_us < next)
+      next = timers[i]->next_us;
+  return next;
+}
+
+void sim_advance_us(uint64_t us) {
+  uint64_t target = sim_time_us + us;
+  while (true) {
+    repeating_timer_t *due = NULL;
+    for (uint i = 0; i < timer_count; ++i)
+      if (timers[i]->active && timers[i]->next_us <= target && (!due || timers[i]->next_us < due->next_us))
+        due = timers[i];
+
+    int alarm = -1;
+    for (uint i = 0; i < SIM_ALARMS; ++i)
+      if (alarm_target_us[i] <= target && (alarm < 0 || alarm_target_us[i] < alarm_target_us[alarm]))
+        alarm = i;
+
+    uint64_t edge_us = sim_button_next_us();
+    if (edge_us <= target && (!due || edge_us < due->next_us) && (alarm < 0 || edge_us < alarm_target_us[alarm])) {
+      if (edge_us > sim_time_us)
+        sim_time_us = edge_us;
+      adc_stream(sim_time_us);
+      sim_button_edge();
+      continue;
+    }
+
+    if (alarm >= 0 && (!due || alarm_target_us[alarm] <= due->next_us)) {
+      if (alarm_target_us[alarm] > sim_time_us)
+        sim_time_us = alarm_target_us[alarm];
+      alarm_target_us[alarm] = UINT64_MAX;
+      alarm_callbacks[alarm](alarm);
+      continue;
+    }
+
+    if (!due)
+      break;
+
+    if (due->next_us > sim_time_us)
+      sim_time_us = due->next_us;
+    int64_t delay = due->delay_us < 0 ? -due->delay_us : due->delay_us;
+    due->next_us += delay;
+    if (!due->callback(due))
+      due->active = false;
+    sim_frame_tick(due);
+  }
+  sim_time_us = target;
+  adc_stream(sim_time_us);
+}
+
+// ---------------------------------------------------------------------------------------------
+// núcleos: execução alternada, o tempo virtual só avança quando o core0 espera
+
+static pthread_mutex_t core_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t core_cond = PTHREAD_COND_INITIALIZER;
+static uint core_turn = 0;
+static bool core1_running = false;
+static __thread uint core_num = 0;
+static void (*core1_entry)(void);
+
+uint get_core_num(void) { return core_num; }
+
+static void core_switch(void) {
+  uint other = core_num ^ 1;
+  pthread_mutex_lock(&core_lock);
+  core_turn = other;
+  pthread_cond_broadcast(&core_cond);
+  while (core_turn != core_num)
+    pthread_cond_wait(&core_cond, &core_lock);
+  pthread_mutex_unlock(&core_lock);
+}
+
+static void *core1_thread(void *arg) {
+  (void)arg;
+  core_num = 1;
+  pthread_mutex_lock(&core_lock);
+  while (core_turn != 1)
+    pthread_cond_wait(&core_cond, &core_lock);
+  pthread_mutex_unlock(&core_lock);
+  core1_entry();
+  return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+  pthread_t thread;
+  core1_entry = entry;
+  core1_running = true;
+  pthread_create(&thread, NULL, core1_thread, NULL);
+}
+
+// o firmware está esperando: pula direto para o próximo evento agendado, sem passar de limit_us
+void sim_idle_until(uint64_t limit_us) {
+  if (core1_running) {
+    core_switch();
+    if (core_num == 1)
+      return;
+  }
+  uint64_t next = sim_next_event_us();
+  uint64_t dma_next = sim_dma_next_event_us();
+  if (dma_next < next)
+    next = dma_next;
+  if (limit_us < next)
+    next = limit_us;
+  sim_advance_us(next > sim_time_us && next != UINT64_MAX ? next - sim_time_us : 1);
+}
+
+void sim_idle(void) {
+  sim_idle_until(UINT64_MAX);
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+  if (timer_count == SIM_MAX_TIMERS)
+    return false;
+  int64_t delay = delay_us < 0 ? -delay_us : delay_us;
+  *out = (repeating_timer_t){ .delay_us = delay_us, .callback = callback, .user_data = user_data, .next_us = sim_time_us + delay, .active = true };
+  // um timer cancelado e adicionado de novo volta à mesma posição (o primeiro segue sendo o relógio de quadros)
+  for (uint i = 0; i < timer_count; ++i)
+    if (timers[i] == out)
+      return true;
+  timers[timer_count++] = out;
+  return true;
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+  bool was_active = timer->active;
+  timer->active = false;
+  return was_active;
+}
+
+// ---------------------------------------------------------------------------------------------
+// GPIO
+
+static gpio_irq_callback_t gpio_callback;
+static uint32_t gpio_irq_mask[32];
+static bool gpio_level[32];
+
+void gpio_init(uint gpio) { gpio_level[gpio] = false; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_put(uint gpio, bool value) { gpio_level[gpio] = value; sim_stats.gpio_writes++; }
+bool gpio_get(uint gpio) { return gpio_level[gpio]; }
+void gpio_pull_up(uint gpio) { gpio_level[gpio] = true; }
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+  if (enabled)
+    gpio_irq_mask[gpio] |= events;
+  else
+    gpio_irq_mask[gpio] &= ~events;
+}
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+  gpio_callback = callback;
+  gpio_set_irq_enabled(gpio, events, enabled);
+}
+
+// ---------------------------------------------------------------------------------------------
+// I2C com SSD1306 virtuais (modo de endereçamento vertical) nos endereços 0x3C e 0x3D, os dois
+// valores do pino SA0
+
+static i2c_hw_t i2c_hw[2] = { { .status = I2C_IC_STATUS_TFE_BITS }, { .status = I2C_IC_STATUS_TFE_BITS } };
+i2c_inst_t sim_i2c_inst[2] = { { &i2c_hw[0], 100000, 0 }, { &i2c_hw[1], 100000, 1 } };
+static uint64_t i2c_free_at_us[2];
+static uint64_t i2c_dma_until_us[2]; // fim do último envio por DMA em cada barramento
+
+typedef struct {
+  uint8_t gddram[128][8];
+  uint8_t col_start, col_end, page_start, page_end, col, page;
+  uint8_t start_line; // linha da GDDRAM mostrada no topo
+  bool display_on, charge_pump;
+  uint display_offs; // comandos de desligar o painel (0xAE) recebidos
+  uint8_t pending_command, pending_args, args[2];
+} sim_ssd1306_t;
+
+#define SIM_PANEL_ADDR 0x3C
+#define SIM_PANELS 2
+
+static sim_ssd1306_t panels[SIM_PANELS] = {
+  { .col_end = 127, .page_end = 7 },
+  { .col_end = 127, .page_end = 7 },
+};
+
+static sim_ssd1306_t *sim_panel(uint8_t address) {
+  if (address < SIM_PANEL_ADDR || address >= SIM_PANEL_ADDR + SIM_PANELS) {
+    fprintf(stderr, "sim: nenhum SSD1306 no endereco 0x%02x\n", address);
+    abort();
+  }
+  return &panels[address - SIM_PANEL_ADDR];
+}
+
+static void panel_command(sim_ssd1306_t *p, uint8_t byte) {
+  if (p->pending_args) {
+    p->args[p->pending_command == 0x21 || p->pending_command == 0x22 ? 2 - p->pending_args : 0] = byte;
+    if (--p->pending_args == 0) {
+      if (p->pending_command == 0x21) {
+        p->col_start = p->col = p->args[0];
+        p->col_end = p->args[1];
+      } else if (p->pending_command == 0x22) {
+        p->page_start = p->page = p->args[0];
+        p->page_end = p->args[1];
+      } else if (p->pending_command == 0x8D) {
+        p->charge_pump = p->args[0] & 0x04;
+      }
+    }
+    return;
+  }
+
+  p->pending_command = byte;
+  switch (byte) {
+    case 0x21: case 0x22:
+      p->pending_args = 2;
+      break;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      p->pending_args = 1;
+      break;
+    case 0xAE:
+      p->display_on = false;
+      p->display_offs++;
+      break;
+    case 0xAF:
+      p->display_on = true;
+      break;
+    default:
+      if ((byte & 0xC0) == 0x40)
+        p->start_line = byte & 0x3F;
+      break;
+  }
+}
+
+static void panel_data(sim_ssd1306_t *p, uint8_t byte) {
+  p->gddram[p->col & 127][p->page & 7] = byte;
+  if (++p->page > p->page_end) {
+    p->page = p->page_start;
+    if (++p->col > p->col_end)
+      p->col = p->col_start;
+  }
+}
+
+static void panel_transaction(uint8_t address, const uint8_t *src, size_t len) {
+  sim_ssd1306_t *panel = sim_panel(address);
+  size_t i = 0;
+  while (i < len) {
+    uint8_t control = src[i++];
+    bool data = control & 0x40;
+    size_t last = (control & 0x80) ? i + 1 : len;
+    for (; i < last && i < len; ++i)
+      data ? panel_data(panel, src[i]) : panel_command(panel, src[i]);
+  }
+}
+
+const uint8_t *sim_panel_column(uint8_t address, uint x) { return sim_panel(address)->gddram[x]; }
+uint8_t sim_panel_start_line(uint8_t address) { return sim_panel(address)->start_line; }
+bool sim_panel_display_on(uint8_t address) { return sim_panel(address)->display_on; }
+bool sim_panel_charge_pump(uint8_t address) { return sim_panel(address)->charge_pump; }
+uint sim_panel_display_offs(uint8_t address) { return sim_panel(address)->display_offs; }
+
+// escrita no barramento: com um DMA ainda transmitindo nele, os bytes se misturariam no fio
+static void i2c_check_collision(i2c_inst_t *i2c) {
+  if (sim_time_us < i2c_dma_until_us[i2c->index])
+    sim_stats.i2c_collisions++;
+}
+
+// lê o texto da tela em células de 8x8 alinhadas às páginas, na ordem em que as linhas aparecem com
+// a linha inicial atual: cada célula vira o caractere da fonte com as mesmas colunas, ' ' quando
+// apagada e '#' quando não é um glifo
+void sim_panel_text(uint8_t address, char text[8][128 / 8 + 1]) {
+  const sim_ssd1306_t *panel = sim_panel(address);
+  for (uint row = 0; row < 8; ++row) {
+    uint page = (row + panel->start_line / 8) % 8;
+    uint length = 0;
+    for (uint cell = 0; cell < 128 / 8; ++cell) {
+      uint8_t cell_columns[ASSET_GLYPH_WIDTH];
+      bool blank = true;
+      for (uint i = 0; i < ASSET_GLYPH_WIDTH; ++i) {
+        cell_columns[i] = panel->gddram[cell * 8 + i][page];
+        blank &= cell_columns[i] == 0;
+      }
+
+      char found = blank ? ' ' : '#';
+      uint8_t glyph[ASSET_GLYPH_WIDTH];
+      for (int c = 1; c < 128 && found == '#'; ++c)
+        if (asset_glyph_decode(c, glyph) && memcmp(glyph, cell_columns, sizeof(glyph)) == 0)
+          found = c;
+      text[row][cell] = found;
+      if (found != ' ')
+        length = cell + 1;
+    }
+    text[row][length] = '\0';
+  }
+}
+
+static uint64_t i2c_bytes_us(i2c_inst_t *i2c, size_t bytes) {
+  // 9 bits por byte (8 + ACK) mais start/stop, arredondado para cima
+  return (bytes * 9 + 2) * 1000000ull / i2c->baudrate + 1;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  i2c->baudrate = baudrate;
+  return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  (void)nostop;
+  i2c_check_collision(i2c);
+  uint64_t start = sim_time_us > i2c_free_at_us[i2c->index] ? sim_time_us : i2c_free_at_us[i2c->index];
+  uint64_t busy = i2c_bytes_us(i2c, len + 1);
+  panel_transaction(addr, src, len);
+  sim_stats.i2c_bytes += len + 1;
+  sim_stats.i2c_transactions++;
+  sim_stats.i2c_busy_us += busy;
+  sim_stats.cpu_blocked_us += start + busy - sim_time_us;
+  i2c_free_at_us[i2c->index] = start + busy;
+  sim_advance_us(start + busy - sim_time_us);
+  return (int)len;
+}
+
+// ---------------------------------------------------------------------------------------------
+// PIO (WS2812)
+
+pio_hw_t sim_pio_hw[2];
+static pio_sm_config sm_configs[2][4];
+static uint32_t sm_claimed[2];
+static uint64_t pio_free_at_us[2][4];
+
+uint pio_add_program(PIO pio, const pio_program_t *program) { (void)pio; (void)program; return 0; }
+bool pio_can_add_program(PIO pio, const pio_program_t *program) { (void)pio; (void)program; return true; }
+int pio_claim_unused_sm(PIO pio, bool required) {
+  uint index = pio_get_index(pio);
+  for (uint sm = 0; sm < 4; ++sm) {
+    if (!(sm_claimed[index] & (1u << sm))) {
+      sm_claimed[index] |= 1u << sm;
+      return sm;
+    }
+  }
+  if (required) {
+    fprintf(stderr, "sim: nenhuma maquina de estados livre\n");
+    abort();
+  }
+  return -1;
+}
+void pio_sm_claim(PIO pio, uint sm) { sm_claimed[pio_get_index(pio)] |= 1u << sm; }
+void pio_gpio_init(PIO pio, uint pin) { (void)pio; (void)pin; }
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) { (void)pio; (void)sm; (void)pin_base; (void)pin_count; (void)is_out; return 0; }
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) { (void)initial_pc; sm_configs[pio_get_index(pio)][sm] = *config; return 0; }
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) { (void)pio; (void)sm; (void)enabled; }
+const pio_sm_config *sim_pio_sm_config(PIO pio, uint sm) { return &sm_configs[pio_get_index(pio)][sm]; }
+
+// cada palavra carrega pull_threshold bits; com vários pinos de saída cada bit transmitido a 800 kHz
+// consome um plano com um bit por pino, arredondado para potência de 2 (ver ws2812_parallel.pio)
+static uint64_t pio_words_us(PIO pio, uint sm, uint32_t words) {
+  const pio_sm_config *config = &sm_configs[pio_get_index(pio)][sm];
+  uint plane_bits = 1;
+  while (plane_bits < config->out_count)
+    plane_bits <<= 1;
+  return words * (config->pull_threshold / plane_bits) * 1000000ull / SIM_WS2812_HZ;
+}
+
+static uint64_t pio_queue_words(PIO pio, uint sm, uint32_t words) {
+  uint64_t *free_at = &pio_free_at_us[pio_get_index(pio)][sm];
+  uint64_t start = sim_time_us > *free_at ? sim_time_us : *free_at;
+  uint64_t busy = pio_words_us(pio, sm, words);
+  *free_at = start + busy;
+  sim_stats.pio_words += words;
+  sim_stats.pio_busy_us += busy;
+  return *free_at;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+  (void)data;
+  // a FIFO de 8 posições absorve as primeiras palavras; depois disso a CPU espera o fio
+  uint64_t done = pio_queue_words(pio, sm, 1);
+  uint64_t fifo = pio_words_us(pio, sm, 8);
+  if (done > sim_time_us + fifo) {
+    sim_stats.cpu_blocked_us += done - fifo - sim_time_us;
+    sim_advance_us(done - fifo - sim_time_us);
+  }
+}
+
+// ---------------------------------------------------------------------------------------------
+// DMA
+
+typedef struct {
+  bool claimed;
+  dma_channel_config config;
+  volatile void *write_addr;
+  const volatile void *read_addr;
+  uint32_t count;
+  uint64_t busy_until_us;
+  uint32_t position; // transferências já feitas num fluxo contínuo (ADC)
+  bool adc_stream;
+} sim_dma_channel_t;
+
+static sim_dma_channel_t channels[NUM_DMA_CHANNELS];
+
+static uint32_t dma_timer_fraction[4];
+static uint dma_timers_claimed;
+
+int dma_claim_unused_timer(bool required) {
+  for (uint i = 0; i < 4; ++i) {
+    if (!(dma_timers_claimed & (1u << i))) {
+      dma_timers_claimed |= 1u << i;
+      return i;
+    }
+  }
+  if (required) {
+    fprintf(stderr, "sim: nenhum timer de DMA livre\n");
+    abort();
+  }
+  return -1;
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator) {
+  dma_timer_fraction[timer] = (uint32_t)numerator << 16 | denominator;
+}
+
+int dma_claim_unused_channel(bool required) {
+  for (uint i = 0; i < NUM_DMA_CHANNELS; ++i) {
+    if (!channels[i].claimed) {
+      channels[i].claimed = true;
+      return i;
+    }
+  }
+  if (required) {
+    fprintf(stderr, "sim: nenhum canal de DMA livre\n");
+    abort();
+  }
+  return -1;
+}
+
+void dma_channel_unclaim(uint channel) { channels[channel].claimed = false; }
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  (void)channel;
+  return (dma_channel_config){ .size = DMA_SIZE_32, .read_increment = true, .write_increment = false, .dreq = 0x3f };
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger) {
+  sim_dma_channel_t *ch = &channels[channel];
+  ch->config = *config;
+  ch->write_addr = write_addr;
+  ch->read_addr = read_addr;
+  ch->count = transfer_count;
+  if (trigger)
+    dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+}
+
+// o endereço do escravo é o que está no IC_TAR quando o DMA começa
+static uint64_t dma_to_i2c(i2c_inst_t *i2c, const uint16_t *words, uint32_t count) {
+  uint8_t transaction[2048];
+  size_t len = 0;
+  uint64_t bytes = 0;
+  i2c_check_collision(i2c);
+  for (uint32_t i = 0; i < count; ++i) {
+    transaction[len++] = words[i] & 0xFF;
+    if ((words[i] & I2C_IC_DATA_CMD_STOP_BITS) || i + 1 == count || len == sizeof(transaction)) {
+      panel_transaction(i2c->hw->tar, transaction, len);
+      bytes += len + 1;
+      sim_stats.i2c_transactions++;
+      len = 0;
+    }
+  }
+
+  uint64_t *free_at = &i2c_free_at_us[i2c->index];
+  uint64_t start = sim_time_us > *free_at ? sim_time_us : *free_at;
+  uint64_t busy = i2c_bytes_us(i2c, bytes);
+  sim_stats.i2c_bytes += bytes;
+  sim_stats.i2c_busy_us += busy;
+  *free_at = start + busy;
+  i2c_dma_until_us[i2c->index] = *free_at;
+  return *free_at;
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+  sim_dma_channel_t *ch = &channels[channel];
+  ch->read_addr = read_addr;
+  ch->count = transfer_count;
+  ch->busy_until_us = sim_time_us;
+  ch->adc_stream = read_addr == &sim_adc_hw.fifo;
+  ch->position = 0;
+  if (ch->adc_stream) {
+    ch->busy_until_us = UINT64_MAX - 1;
+    return;
+  }
+
+  for (uint i = 0; i < 2; ++i) {
+    if (ch->write_addr == &i2c_hw[i].data_cmd) {
+      ch->busy_until_us = dma_to_i2c(&sim_i2c_inst[i], (const uint16_t *)read_addr, transfer_count);
+      return;
+    }
+    for (uint sm = 0; sm < 4; ++sm) {
+      if (ch->write_addr == &sim_pio_hw[i].txf[sm]) {
+        // o DMA termina quando a última palavra entra na FIFO de 8 posições
+        uint64_t done = pio_queue_words(&sim_pio_hw[i], sm, transfer_count);
+        sim_stats.pio_frames++;
+        bool dark = true;
+        for (uint32_t w = 0; w < transfer_count && dark; ++w)
+          dark = ((const uint32_t *)read_addr)[w] == 0;
+        sim_stats.pio_dark_frames += dark;
+        uint64_t fifo = pio_words_us(&sim_pio_hw[i], sm, 8);
+        ch->busy_until_us = done > sim_time_us + fifo ? done - fifo : sim_time_us;
+        return;
+      }
+    }
+  }
+
+  // fluxo para o registrador de comparação do PWM no ritmo de um timer de DMA: sem CPU por amostra
+  for (uint slice = 0; slice < 8; ++slice) {
+    if (ch->write_addr == &sim_pwm_hw.slice[slice].cc && transfer_count > 0) {
+      uint timer = ch->config.dreq - dma_get_timer_dreq(0);
+      uint32_t fraction = timer < 4 ? dma_timer_fraction[timer] : 0;
+      uint64_t period_ns = fraction ? (uint64_t)(fraction & 0xFFFF) * 1000000000ull / ((fraction >> 16) * 125000000ull) : 0;
+      uint16_t last = ((const uint16_t *)read_addr)[transfer_count - 1];
+      sim_pwm_hw.slice[slice].cc = (uint32_t)last << 16 | last;
+      ch->busy_until_us = sim_time_us + transfer_count * period_ns / 1000;
+      sim_stats.pwm_dma_samples += transfer_count;
+      return;
+    }
+  }
+
+  // cópia memória -> memória
+  size_t size = 1u << ch->config.size;
+  if (ch->config.write_increment && ch->config.read_increment)
+    memcpy((void *)ch->write_addr, (const void *)read_addr, transfer_count * size);
+}
+
+bool dma_channel_is_busy(uint channel) { return sim_time_us < channels[channel].busy_until_us; }
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  while (dma_channel_is_busy(channel))
+    sim_idle();
+}
+
+void dma_channel_abort(uint channel) { channels[channel].busy_until_us = sim_time_us; }
+
+uint64_t sim_dma_next_event_us(void) {
+  uint64_t next = UINT64_MAX;
+  for (uint i = 0; i < NUM_DMA_CHANNELS; ++i)
+    if (!channels[i].adc_stream && channels[i].busy_until_us > sim_time_us && channels[i].busy_until_us < next)
+      next = channels[i].busy_until_us;
+  return next;
+}
+
+// ---------------------------------------------------------------------------------------------
+// ADC: joystick descrevendo um círculo lento em torno do centro. No modo contínuo (round robin +
+// FIFO + DMA) as amostras são geradas sob demanda conforme o tempo virtual avança
+
+adc_hw_t sim_adc_hw;
+static uint adc_input;
+static uint adc_round_robin;
+static float adc_clkdiv;
+static bool adc_running;
+
+// o joystick descreve um círculo a cada 4 s, exceto entre SIM_JOYSTICK_REST_US e
+// SIM_JOYSTICK_MOVE_US, quando fica solto no centro (o suficiente para o firmware entrar no modo
+// ocioso duas vezes: uma acordada pelo botão do roteiro e outra pelo joystick)
+static uint16_t sim_joystick(uint input) {
+  double phase = (double)sim_time_us / 4e6 * 2 * M_PI;
+  double amplitude = sim_time_us >= SIM_JOYSTICK_REST_US && sim_time_us < SIM_JOYSTICK_MOVE_US ? 0 : 1800;
+  double value = 2048 + amplitude * (input == 0 ? cos(phase) : sin(phase)) + (rand() % 64) - 32;
+  return (uint16_t)value;
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) { (void)gpio; }
+void adc_select_input(uint input) { adc_input = input; }
+uint adc_get_selected_input(void) { return adc_input; }
+void adc_set_round_robin(uint input_mask) { adc_round_robin = input_mask; }
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) { (void)en; (void)dreq_en; (void)dreq_thresh; (void)err_in_fifo; (void)byte_shift; }
+void adc_set_clkdiv(float clkdiv) { adc_clkdiv = clkdiv; }
+void adc_fifo_drain(void) {}
+
+uint16_t adc_read(void) {
+  // conversão de 96 ciclos a 48 MHz
+  sim_advance_us(2);
+  sim_stats.cpu_blocked_us += 2;
+  sim_stats.adc_samples++;
+  return sim_joystick(adc_input);
+}
+
+static uint adc_next_input(void) {
+  uint input = adc_input;
+  if (adc_round_robin) {
+    do {
+      adc_input = (adc_input + 1) % 5;
+    } while (!(adc_round_robin & (1u << adc_input)));
+  }
+  return input;
+}
+
+static uint64_t adc_sample_period_ns(void) {
+  double div = adc_clkdiv < 96 ? 96 : adc_clkdiv + 1;
+  return (uint64_t)(div * 1e9 / 48e6);
+}
+
+// gera as conversões ocorridas desde o último avanço e entrega ao canal de DMA que lê a FIFO
+static uint64_t adc_last_ns;
+
+void adc_run(bool run) {
+  adc_running = run;
+  adc_last_ns = sim_time_us * 1000;
+}
+
+static void adc_stream(uint64_t now_us) {
+  if (!adc_running) {
+    return;
+  }
+  uint64_t period = adc_sample_period_ns();
+  uint64_t now_ns = now_us * 1000;
+  uint64_t conversions = (now_ns - adc_last_ns) / period;
+  adc_last_ns += conversions * period;
+
+  for (uint c = 0; c < NUM_DMA_CHANNELS; ++c) {
+    sim_dma_channel_t *ch = &channels[c];
+    if (!ch->adc_stream || ch->position >= ch->count)
+      continue;
+    uint32_t ring = ch->config.ring_write && ch->config.ring_bits ? (1u << ch->config.ring_bits) / 2 : ch->count;
+    // só as últimas voltas do buffer circular importam; mantém a ordem do round robin
+    for (uint64_t n = 0; n < conversions && ch->position < ch->count; ++n) {
+      uint16_t sample = sim_joystick(adc_next_input());
+      ((uint16_t *)ch->write_addr)[ch->position % ring] = sample;
+      ch->position++;
+    }
+    return;
+  }
+}
+
+// ---------------------------------------------------------------------------------------------
+// roteiro de botões: (instante, gpio, tempo pressionado). Cada pressão repica duas vezes ao descer
+// e uma ao subir. B sobe o volume, A logo depois de B, B segurado (repetição), SW desligando e
+// religando o LED verde e, com o firmware ocioso, B acordando o sistema
+
+#define SIM_BOUNCE_US 300
+
+static const struct { uint64_t time_us; uint gpio; uint64_t hold_us; } presses[] = {
+  { 1000000, 6, 80000 }, { 1300000, 6, 40000 }, { 1350000, 5, 60000 },
+  { 2000000, 22, 120000 }, { 2500000, 22, 90000 }, { 3000000, 6, 1000000 },
+  { SIM_WAKE_PRESS_US, 6, 80000 },
+};
+
+typedef struct {
+  uint64_t time_us;
+  uint gpio;
+  bool level;
+} sim_edge_t;
+
+static sim_edge_t edges[sizeof(presses) / sizeof(presses[0]) * 6];
+static uint edge_count;
+static uint edge_next;
+
+static int sim_edge_compare(const void *a, const void *b) {
+  const sim_edge_t *x = a, *y = b;
+  return x->time_us < y->time_us ? -1 : x->time_us > y->time_us;
+}
+
+static void sim_button_timeline(void) {
+  for (uint i = 0; i < sizeof(presses) / sizeof(presses[0]); ++i) {
+    uint64_t t = presses[i].time_us, hold = presses[i].hold_us;
+    uint gpio = presses[i].gpio;
+    edges[edge_count++] = (sim_edge_t){ t, gpio, false };
+    edges[edge_count++] = (sim_edge_t){ t + SIM_BOUNCE_US, gpio, true };
+    edges[edge_count++] = (sim_edge_t){ t + 2 * SIM_BOUNCE_US, gpio, false };
+    edges[edge_count++] = (sim_edge_t){ t + hold, gpio, true };
+    edges[edge_count++] = (sim_edge_t){ t + hold + SIM_BOUNCE_US, gpio, false };
+    edges[edge_count++] = (sim_edge_t){ t + hold + 2 * SIM_BOUNCE_US, gpio, true };
+  }
+  qsort(edges, edge_count, sizeof(edges[0]), sim_edge_compare);
+}
+
+static uint64_t sim_button_next_us(void) {
+  if (edge_count == 0)
+    sim_button_timeline();
+  return edge_next < edge_count ? edges[edge_next].time_us : UINT64_MAX;
+}
+
+// aplica a próxima borda do roteiro e chama a interrupção de GPIO se ela estiver habilitada
+static void sim_button_edge(void) {
+  const sim_edge_t *edge = &edges[edge_next++];
+  gpio_level[edge->gpio] = edge->level;
+  uint32_t event = edge->level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if (gpio_callback && (gpio_irq_mask[edge->gpio] & event))
+    gpio_callback(edge->gpio, event);
+}
+
+// ---------------------------------------------------------------------------------------------
+// stdio: SIM_DUMP_AT_US pede o trace em binário, que vai para trace.bin. SIM_CONSOLE traz linhas de
+// comando separadas por vírgula, digitadas a partir de SIM_CONSOLE_AT_US (4 s por padrão, depois do
+// roteiro de botões)
+
+static FILE *dump_file;
+
+int getchar_timeout_us(uint32_t timeout_us) {
+  (void)timeout_us;
+  static bool requested = false;
+  const char *at = getenv("SIM_DUMP_AT_US");
+  if (!requested && at && sim_time_us >= strtoull(at, NULL, 10)) {
+    requested = true;
+    dump_file = fopen("trace.bin", "wb");
+    return 'T';
+  }
+
+  // um caractere por chamada, como chegam pela USB; a última linha também termina com '\n'
+  static size_t typed = 0;
+  const char *input = getenv("SIM_CONSOLE");
+  const char *input_at = getenv("SIM_CONSOLE_AT_US");
+  if (input && typed <= strlen(input) && sim_time_us >= (input_at ? strtoull(input_at, NULL, 10) : 4000000)) {
+    char c = input[typed++];
+    return c == ',' || c == '\0' ? '\n' : c;
+  }
+  return PICO_ERROR_TIMEOUT;
+}
+
+int putchar_raw(int c) {
+  if (dump_file) {
+    fputc(c, dump_file);
+    fflush(dump_file);
+  }
+  return c;
+}
+
+static systick_hw_t systick;
+
+systick_hw_t *sim_systick(void) {
+  systick.cvr = (uint32_t)(0xFFFFFFu - sim_time_us * 125u) & 0xFFFFFFu;
+  return &systick;
+}
+
+// ---------------------------------------------------------------------------------------------
+// PWM
+
+pwm_hw_t sim_pwm_hw;
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) { (void)slice_num; (void)c; (void)start; sim_stats.pwm_writes += 3; }
+void pwm_set_enabled(uint slice_num, bool enabled) { (void)slice_num; (void)enabled; sim_stats.pwm_writes++; }
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) { (void)slice_num; (void)integer; (void)fract; sim_stats.pwm_writes++; }
+void pwm_set_wrap(uint slice_num, uint16_t wrap) { (void)slice_num; (void)wrap; sim_stats.pwm_writes++; }
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) { (void)slice_num; (void)chan; (void)level; sim_stats.pwm_writes++; }
+void pwm_set_gpio_level(uint gpio, uint16_t level) { (void)gpio; (void)level; sim_stats.pwm_writes++; }
+
+// ---------------------------------------------------------------------------------------------
+// relatório por quadro. O primeiro repeating timer registrado é tratado como o relógio de quadros
+
+static uint64_t frames;
+
+static double host_cpu_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void sim_frame_tick(repeating_timer_t *timer) {
+  static uint64_t frame_limit = 0;
+  if (frame_limit == 0) {
+    const char *env = getenv("SIM_FRAMES");
+    frame_limit = env && strtoull(env, NULL, 10) ? strtoull(env, NULL, 10) : 1000;
+  }
+
+  if (timer_count == 0 || timer != timers[0])
+    return;
+  if (++frames < frame_limit)
+    return;
+
+  // o tempo de CPU do host inclui o custo do próprio modelo; serve para comparar versões do firmware,
+  // não como estimativa de ciclos no RP2040
+  sim_stats_t *s = &sim_stats;
+  double n = (double)frames;
+  printf("sim: %llu quadros, %.1f ms virtuais\n", (unsigned long long)frames, sim_time_us / 1000.0);
+  printf("sim: por quadro: i2c %.1f bytes / %.2f transacoes / %.1f us ocupado | pio %.1f palavras / %.1f us ocupado\n",
+    s->i2c_bytes / n, s->i2c_transactions / n, s->i2c_busy_us / n, s->pio_words / n, s->pio_busy_us / n);
+  printf("sim: por quadro: cpu presa em barramento %.1f us | cpu do host %.2f us | pwm %.2f escritas + %.1f amostras por DMA | gpio %.2f escritas | adc %.2f amostras\n",
+    s->cpu_blocked_us / n, host_cpu_us() / n, s->pwm_writes / n, s->pwm_dma_samples / n, s->gpio_writes / n, s->adc_samples / n);
+  // com comandos pelo console, o texto da tela mostra o efeito deles
+  if (getenv("SIM_CONSOLE")) {
+    char text[8][128 / 8 + 1];
+    sim_panel_text(SIM_PANEL_ADDR, text);
+    printf("sim: tela |");
+    for (uint row = 0; row < 8; ++row)
+      printf("%s|", text[row]);
+    printf("\n");
+  }
+  printf("sim_result frames=%llu i2c_bytes=%.1f i2c_transactions=%.2f i2c_busy_us=%.1f pio_words=%.1f pio_busy_us=%.1f cpu_blocked_us=%.1f host_cpu_us=%.2f\n",
+    (unsigned long long)frames, s->i2c_bytes / n, s->i2c_transactions / n, s->i2c_busy_us / n,
+    s->pio_words / n, s->pio_busy_us / n, s->cpu_blocked_us / n, host_cpu_us() / n);
+  fflush(stdout);
+  exit(0);
+}
@@ -0,0 +1,35 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "pico/stdlib.h"
+
+// contadores acumulados pela simulação
+typedef struct {
+  uint64_t i2c_bytes, i2c_transactions, i2c_busy_us;
+  uint64_t pio_words, pio_busy_us;
+  uint64_t pio_frames, pio_dark_frames; // envios por DMA à PIO (quadros da matriz) e os todo apagados
+  uint64_t pwm_writes, pwm_dma_samples, gpio_writes;
+  uint64_t adc_samples;
+  uint64_t cpu_blocked_us; // tempo virtual em que a CPU ficou presa num barramento bloqueante
+  uint64_t i2c_collisions; // escritas num barramento I2C com um envio por DMA ainda em andamento nele
+} sim_stats_t;
+
+// roteiro de entradas: joystick solto no centro entre REST e MOVE, e B apertado no meio desse tempo
+#define SIM_JOYSTICK_REST_US 8000000
+#define SIM_JOYSTICK_MOVE_US 80000000
+#define SIM_WAKE_PRESS_US 44000000
+
+extern sim_stats_t sim_stats;
+extern uint sim_alarm_misses; // próximos hardware_alarm_set_target que encontram o alvo já passado
+
+uint64_t sim_dma_next_event_us(void);
+// SSD1306 virtuais, um por endereço (0x3C e 0x3D)
+const uint8_t *sim_panel_column(uint8_t address, uint x); // conteúdo atual da GDDRAM
+uint8_t sim_panel_start_line(uint8_t address); // linha da GDDRAM no topo da tela
+bool sim_panel_display_on(uint8_t address);
+bool sim_panel_charge_pump(uint8_t address);
+uint sim_panel_display_offs(uint8_t address);
+void sim_panel_text(uint8_t address, char text[8][128 / 8 + 1]); // texto da tela, de cima para baixo
+void sim_frame_tick(repeating_timer_t *timer);
+
+#endif
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+# Gera o cabeçalho dos assets (sprites da matriz e fonte do OLED) a partir dos arquivos de texto em
+# assets/. Roda no build (ver CMakeLists.txt); a saída só é incluída por lib/assets.c. Uso:
+#   python3 tools/asset_gen.py assets/sprites.txt assets/font.txt lib/leds_matrix.h saida/assets_data.h
+#
+# Sprites: paleta de até 16 cores e, por sprite, corridas de índices da paleta já na ordem do fio,
+# um byte por corrida: (comprimento - 1) << 4 | índice. A ordem do fio sai da geometria do painel
+# em np_config (lib/leds_matrix.h), com a mesma conta de ws2812_grid_index.
+# Fonte: as colunas de cada glifo no formato de página do SSD1306 (bit 0 = linha de cima), sem as
+# colunas vazias das bordas; um byte de cabeçalho guarda primeira coluna << 4 | número de colunas.
+# Os caracteres com glifo são agrupados em faixas de códigos consecutivos no lugar de uma tabela de
+# 256 entradas.
+import os
+import re
+import sys
+
+GLYPH_SIZE = 8
+
+
+def blocks(path, keyword, rows):
+    # devolve (nome, linhas) de cada bloco "<keyword> <nome>" e as diretivas "palette"
+    palette, items = [], []
+    lines = [line.rstrip('\n') for line in open(path, encoding='utf-8')]
+    i = 0
+    while i < len(lines):
+        words = lines[i].split()
+        i += 1
+        if not words or words[0].startswith('#'):
+            continue
+        if words[0] == 'palette':
+            palette.append((words[1], int(words[2], 16)))
+        elif words[0] == keyword:
+            art = lines[i:i + rows]
+            i += rows
+            if len(art) != rows:
+                sys.exit('%s: %s %s incompleto' % (path, keyword, words[1]))
+            items.append((words[1], art))
+        else:
+            sys.exit('%s:%d: diretiva desconhecida %r' % (path, i, words[0]))
+    return palette, items
+
+
+def argb_to_wire(argb):
+    # mesmo mapeamento de canais do antigo convertARGBtoMatriz: byte 0 -> R, byte 1 -> G, byte 2 -> B
+    return ((argb & 0x0000FF00) << 16) | ((argb & 0x000000FF) << 16) | ((argb & 0x00FF0000) >> 8)
+
+
+def read_grid(path, field, defines):
+    # campos de um ws2812_grid_t de np_config: { .columns = ..., .rows = ..., .serpentine = true, ... }
+    text = open(path, encoding='utf-8').read()
+    match = re.search(r'np_config\s*=\s*\{.*?\.%s\s*=\s*\{([^}]*)\}' % field, text, re.S)
+    if not match:
+        sys.exit('%s: np_config sem .%s' % (path, field))
+    grid = {'columns': 1, 'rows': 1, 'column_major': False, 'serpentine': False, 'flip_x': False, 'flip_y': False}
+    for key, value in re.findall(r'\.(\w+)\s*=\s*(\w+)', match.group(1)):
+        if key not in grid:
+            sys.exit('%s: campo .%s desconhecido em .%s' % (path, key, field))
+        value = defines.get(value, value)
+        grid[key] = value == 'true' if value in ('true', 'false') else int(value, 0)
+    return grid
+
+
+def read_geometry(path):
+    # o decodificador escreve o sprite direto no buffer do fio: só serve para um painel numa fita
+    text = open(path, encoding='utf-8').read()
+    defines = dict(re.findall(r'^#define\s+(\w+)\s+(\w+)\s*$', text, re.M))
+    tiles = read_grid(path, 'tiles', defines)
+    strips = re.search(r'np_config\s*=\s*\{.*?\.strips\s*=\s*(\w+)', text, re.S)
+    if tiles['columns'] * tiles['rows'] != 1 or not strips or int(defines.get(strips.group(1), strips.group(1)), 0) != 1:
+        sys.exit('%s: os sprites supõem um único painel numa única fita' % path)
+    return read_grid(path, 'tile', defines)
+
+
+def wire_index(grid, x, y):
+    # posição do LED (x, y) na cadeia, igual a ws2812_grid_index em lib/ws2812.c
+    if grid['flip_x']:
+        x = grid['columns'] - 1 - x
+    if grid['flip_y']:
+        y = grid['rows'] - 1 - y
+    major, minor = (x, y) if grid['column_major'] else (y, x)
+    count = grid['rows'] if grid['column_major'] else grid['columns']
+    if grid['serpentine'] and major & 1:
+        minor = count - 1 - minor
+    return major * count + minor
+
+
+def encode_sprites(path, grid):
+    columns, rows = grid['columns'], grid['rows']
+    palette, sprites = blocks(path, 'sprite', rows)
+    if not 0 < len(palette) <= 16:
+        sys.exit('%s: a paleta precisa de 1 a 16 cores' % path)
+    chars = [c for c, _ in palette]
+
+    offsets, data = [], []
+    for name, art in sprites:
+        wire = [0] * (columns * rows)
+        for row, line in enumerate(art):
+            if len(line) != columns:
+                sys.exit('%s: sprite %s: linha %r não tem %d colunas' % (path, name, line, columns))
+            for col, c in enumerate(line):
+                if c not in chars:
+                    sys.exit('%s: sprite %s: cor %r fora da paleta' % (path, name, c))
+                wire[wire_index(grid, col, row)] = chars.index(c)
+
+        offsets.append(len(data))
+        i = 0
+        while i < len(wire):
+            run = 1
+            while i + run < len(wire) and wire[i + run] == wire[i] and run < 16:
+                run += 1
+            data.append((run - 1) << 4 | wire[i])
+            i += run
+    offsets.append(len(data))
+    return [argb_to_wire(argb) for _, argb in palette], [name for name, _ in sprites], offsets, data
+
+
+def encode_font(path):
+    _, glyphs = blocks(path, 'glyph', GLYPH_SIZE)
+    glyphs.sort(key=lambda glyph: glyph[0])
+    ranges, offsets, data = [], [], []
+    for number, (name, art) in enumerate(glyphs):
+        if len(name) != 1 or not 0 < ord(name) < 256:
+            sys.exit('%s: glyph %r: o nome deve ser um único caractere' % (path, name))
+        if ranges and ord(name) == ranges[-1][0] + ranges[-1][1]:
+            ranges[-1][1] += 1
+        elif ranges and ord(name) < ranges[-1][0] + ranges[-1][1]:
+            sys.exit('%s: glyph %s repetido' % (path, name))
+        else:
+            ranges.append([ord(name), 1, number])
+        columns = [0] * GLYPH_SIZE
+        for y, line in enumerate(art):
+            if len(line) != GLYPH_SIZE:
+                sys.exit('%s: glyph %s: linha %r não tem %d colunas' % (path, name, line, GLYPH_SIZE))
+            for x, c in enumerate(line):
+                if c == '#':
+                    columns[x] |= 1 << y
+
+        lit = [x for x, column in enumerate(columns) if column]
+        first = lit[0] if lit else 0
+        count = lit[-1] - first + 1 if lit else 0
+        offsets.append(len(data))
+        data.append(first << 4 | count)
+        data.extend(columns[first:first + count])
+    return ranges, offsets, data
+
+
+def c_array(ctype, name, values, per_line, fmt):
+    lines = ['static const %s %s[%d] = {' % (ctype, name, len(values))]
+    for i in range(0, len(values), per_line):
+        lines.append('  ' + ' '.join(fmt % v + ',' for v in values[i:i + per_line]))
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def main(sprites_path, font_path, geometry_path, out_path):
+    grid = read_geometry(geometry_path)
+    palette, names, sprite_offsets, sprite_data = encode_sprites(sprites_path, grid)
+    font_ranges, glyph_offsets, glyph_data = encode_font(font_path)
+
+    # referência: quadros GRB de 32 bits e a fonte 8x8 com a tabela de índice de 256 bytes
+    raw_sprites = len(names) * grid['columns'] * grid['rows'] * 4
+    raw_font = (len(glyph_offsets) + 1) * GLYPH_SIZE + 256
+    sources = [os.path.join(os.path.basename(os.path.dirname(path)), os.path.basename(path)) for path in (sprites_path, font_path)]
+    out = [
+        '// Gerado por tools/asset_gen.py a partir de %s e %s. Não edite.' % tuple(sources),
+        '// sprites: %d bytes (%d sem compressão) | fonte: %d bytes (%d sem compressão)' % (
+            len(palette) * 4 + len(sprite_offsets) * 2 + len(sprite_data), raw_sprites,
+            len(font_ranges) * 3 + len(glyph_offsets) * 2 + len(glyph_data), raw_font),
+        '',
+        '#define ASSET_SPRITE_COUNT %d' % len(names),
+        '#define ASSET_PALETTE_SIZE %d' % len(palette),
+        '#define ASSET_GLYPH_COUNT %d' % len(glyph_offsets),
+        '#define ASSET_FONT_RANGES %d' % len(font_ranges),
+        '',
+        '// nomes na ordem do arquivo: %s' % ', '.join(names),
+        c_array('uint32_t', 'asset_palette', palette, 4, '0x%08Xu'),
+        c_array('uint16_t', 'asset_sprite_offset', sprite_offsets, 12, '%4d'),
+        c_array('uint8_t', 'asset_sprite_runs', sprite_data, 12, '0x%02X'),
+        '',
+        '// faixas de caracteres com glifo: primeiro código, quantidade e índice do primeiro glifo',
+        c_array('uint8_t', 'asset_font_range_first', [r[0] for r in font_ranges], 12, '%3d'),
+        c_array('uint8_t', 'asset_font_range_count', [r[1] for r in font_ranges], 12, '%3d'),
+        c_array('uint8_t', 'asset_font_range_glyph', [r[2] for r in font_ranges], 12, '%3d'),
+        c_array('uint16_t', 'asset_glyph_offset', glyph_offsets, 12, '%4d'),
+        c_array('uint8_t', 'asset_glyph_data', glyph_data, 12, '0x%02X'),
+        '',
+    ]
+    open(out_path, 'w', encoding='utf-8').write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 5:
+        sys.exit('uso: asset_gen.py sprites.txt font.txt leds_matrix.h saida.h')
+    main(*sys.argv[1:])
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# Decodifica o dump binário do trace (lib/trace.h). Uso:
+#   python3 tools/trace_decode.py trace.bin
+# Para capturar: envie 'T' pela serial USB e grave os bytes recebidos a partir de "TRC1".
+import struct
+import sys
+
+
+def bucket_limit(bucket):
+    if bucket < 4:
+        return bucket
+    exponent = bucket // 4 + 1
+    return ((4 + bucket % 4 + 1) << (exponent - 2)) - 1
+
+
+def main(path):
+    data = open(path, 'rb').read()
+    start = data.find(b'TRC1')
+    if start < 0:
+        sys.exit('cabecalho TRC1 nao encontrado')
+    data = data[start:]
+    offset = 0
+
+    def take(fmt):
+        nonlocal offset
+        values = struct.unpack_from('<' + fmt, data, offset)
+        offset += struct.calcsize('<' + fmt)
+        return values
+
+    _, stage_count, bucket_count, ring_size, clk_hz = take('4sBBHI')
+    cycles_per_us = clk_hz / 1e6
+
+    names = []
+    print('%-16s %8s %10s %10s %10s %10s' % ('estagio', 'n', 'min us', 'media us', 'p99 us', 'max us'))
+    for _ in range(stage_count):
+        (name_len,) = take('B')
+        name = data[offset:offset + name_len].decode()
+        offset += name_len
+        count, min_cycles, max_cycles, sum_cycles = take('IIIQ')
+        buckets = take('%dI' % bucket_count)
+        names.append(name)
+        if count == 0:
+            continue
+
+        target = (count * 99 + 99) // 100
+        seen = 0
+        p99 = max_cycles
+        for bucket, n in enumerate(buckets):
+            seen += n
+            if seen >= target:
+                p99 = min(bucket_limit(bucket), max_cycles)
+                break
+        print('%-16s %8d %10.2f %10.2f %10.2f %10.2f' % (
+            name, count, min_cycles / cycles_per_us, sum_cycles / count / cycles_per_us,
+            p99 / cycles_per_us, max_cycles / cycles_per_us))
+
+    for core in range(2):
+        (head,) = take('I')
+        events = [take('IIB') for _ in range(ring_size)]
+        # do mais antigo para o mais novo
+        recorded = min(head, ring_size)
+        first = head - recorded
+        print('\ncore%d: %d eventos gravados, ultimos %d:' % (core, head, recorded))
+        for i in range(first, head):
+            end_us, cycles, stage = events[i % ring_size]
+            print('  %12d us  %-16s %10.2f us' % (end_us, names[stage], cycles / cycles_per_us))
+
+    checksum = sum(data[:offset]) & 0xFFFFFFFF
+    (expected,) = take('I')
+    if checksum != expected:
+        sys.exit('checksum invalido: %08x != %08x' % (checksum, expected))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1])